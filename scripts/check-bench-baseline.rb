@@ -0,0 +1,86 @@
+#!/usr/bin/env ruby
+# -----------------------------------------------------------------------------
+# 'check-bench-baseline.rb'
+# Derek Anderson
+# 10.16.2026
+#
+# Script to compare the events/s of each benchmark kernel
+# (as written by 'benchbeambackgroundfilters --json') to a
+# baseline, and fail if any kernel got slower by more than
+# some tolerance. Used by 'make bench-check'.
+#
+# The tolerance given here applies to every kernel, unless
+# the baseline overrides it for a kernel (on all grids) in
+# its "tolerances" block, e.g. for kernels so short that
+# they're mostly timing noise.
+#
+# With --update, the baseline's kernels are instead replaced
+# by the results (keeping its "tolerances" block), which is
+# what 'make bench-baseline' does.
+#
+# Usage:
+#   ruby check-bench-baseline.rb <baseline json> <results json> [tolerance]
+#   ruby check-bench-baseline.rb --update <baseline json> <results json>
+# -----------------------------------------------------------------------------
+
+require 'json'
+
+# default allowed fractional slow-down (matches
+# BENCH_TOLERANCE in src/Makefile.am)
+DEFAULT_TOLERANCE = 0.25
+
+# files to compare and allowed fractional slow-down
+update        = (ARGV[0] == "--update")
+ARGV.shift if update
+baseline_file = ARGV[0]
+results_file  = ARGV[1]
+tolerance     = (ARGV[2] || DEFAULT_TOLERANCE).to_f
+abort "Usage: #{$0} [--update] <baseline json> <results json> [tolerance]" if baseline_file.nil? || results_file.nil?
+
+# if updating, swap in new numbers but keep any overrides
+if update
+  reference = File.exist?(baseline_file) ? JSON.parse(File.read(baseline_file)) : {}
+  measured  = JSON.parse(File.read(results_file))
+  reference["units"]   = measured["units"]
+  reference["kernels"] = measured["kernels"]
+  File.write(baseline_file, JSON.pretty_generate(reference) + "\n")
+  puts "Updated #{reference['kernels'].size} kernels in #{baseline_file} (kept #{(reference['tolerances'] || {}).size} tolerance override(s))."
+  exit
+end
+
+reference  = JSON.parse(File.read(baseline_file))
+baseline   = reference["kernels"]
+overrides  = reference["tolerances"] || {}
+results    = JSON.parse(File.read(results_file))["kernels"]
+
+# compare every kernel in the baseline, so that
+# each one has to hold up on its own
+failures = []
+puts format("%-32s %14s %14s %9s", "kernel/grid", "baseline", "now", "change")
+baseline.each do |kernel, expected|
+  measured = results[kernel]
+  if measured.nil?
+    puts format("%-32s %14.4g %14s %9s  MISSING", kernel, expected, "-", "-")
+    failures << kernel
+    next
+  end
+
+  allowed = overrides.fetch(kernel.split("/").first, tolerance).to_f
+  change  = (measured / expected.to_f) - 1.0
+  status  = (change < -allowed) ? "  REGRESSED" : ""
+  puts format("%-32s %14.4g %14.4g %+8.1f%%%s", kernel, expected, measured, 100.0 * change, status)
+  failures << kernel unless status.empty?
+end
+
+# note any kernels that aren't in the baseline yet
+(results.keys - baseline.keys).each do |kernel|
+  puts format("%-32s %14s %14.4g %9s  NEW (not in baseline)", kernel, "-", results[kernel], "-")
+end
+
+if failures.empty?
+  puts "All #{baseline.size} kernels within tolerance (#{(100.0 * tolerance).round(1)}% unless overridden) of baseline."
+else
+  abort "#{failures.size} kernel(s) regressed beyond tolerance (or are missing): #{failures.join(', ')}"
+end
+
+# end -------------------------------------------------------------------------
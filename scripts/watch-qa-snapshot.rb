@@ -0,0 +1,76 @@
+#!/usr/bin/env ruby
+# -----------------------------------------------------------------------------
+# 'watch-qa-snapshot.rb'
+# Derek Anderson
+# 10.16.2026
+#
+# Script to watch the online QA snapshots written by
+# BeamBackgroundFilterAndQA (see the snapshotFile option)
+# and print live background rates for each filter.
+#
+# Usage:
+#   ruby watch-qa-snapshot.rb <snapshot file> [refresh interval in s]
+# -----------------------------------------------------------------------------
+
+# snapshot to watch and how often to check it
+snapshot = ARGV[0]
+interval = (ARGV[1] || 2).to_f
+abort "Usage: #{$0} <snapshot file> [refresh interval in s]" if snapshot.nil?
+
+# read a snapshot into a hash
+def read_snapshot(file)
+  data = { "counts" => {} }
+  File.foreach(file) do |line|
+    fields = line.split
+    next if fields.empty?
+    if fields[0] == "counts"
+      data["counts"][fields[1]] = fields[2..4].map(&:to_i)
+    else
+      data[fields[0]] = fields[1].to_f
+    end
+  end
+  data
+end
+
+# poll snapshot and print rates
+last = nil
+loop do
+  unless File.exist?(snapshot)
+    puts "Waiting for #{snapshot}..."
+    sleep interval
+    next
+  end
+
+  # skip if nothing new was written
+  now = read_snapshot(snapshot)
+  if last && now["sequence"] == last["sequence"]
+    sleep interval
+    next
+  end
+
+  # event rate since last snapshot (or since start)
+  d_evts = now["events"] - (last ? last["events"] : 0)
+  d_time = now["elapsed"] - (last ? last["elapsed"] : 0)
+  rate   = d_time > 0 ? d_evts / d_time : 0
+
+  puts "---- snapshot %d: %d events in %.1f s (%.1f evt/s)" % [now["sequence"], now["events"], now["elapsed"], rate]
+  puts "  %-20s %12s %12s %10s %10s" % ["filter", "events", "bkgd.", "frac. [%]", "last [%]"]
+  now["counts"].each do |name, counts|
+    all, _, bkgd = counts
+    frac = all > 0 ? 100.0 * bkgd / all : 0
+
+    # background fraction since last snapshot
+    recent = frac
+    if last && last["counts"][name]
+      d_all  = all - last["counts"][name][0]
+      d_bkgd = bkgd - last["counts"][name][2]
+      recent = d_all > 0 ? 100.0 * d_bkgd / d_all : 0
+    end
+    puts "  %-20s %12d %12d %10.3f %10.3f" % [name, all, bkgd, frac, recent]
+  end
+
+  last = now
+  sleep interval
+end
+
+# end -------------------------------------------------------------------------
@@ -0,0 +1,101 @@
+/// ===========================================================================
+/*! \file    AllocationCounter.h
+ *  \authors Derek Anderson
+ *  \date    10.16.2026
+ *
+ *  Part of the BeamBackgroundFilterAndQA module, this
+ *  counts heap allocations made while processing an
+ *  event (via the hooks in AllocationHooks.cc).
+ */
+/// ===========================================================================
+
+#ifndef ALLOCATIONCOUNTER_H
+#define ALLOCATIONCOUNTER_H
+
+// c++ utilities
+#include <cstdint>
+
+
+
+// ============================================================================
+//! Entry points of the allocation hooks
+// ============================================================================
+/*! These are defined by libbeambackgroundfilterandqa_allochooks, which
+ *  replaces the global operator new/delete and so has to be preloaded
+ *  (LD_PRELOAD) to see every allocation. They're weak here, so if the
+ *  hooks aren't loaded they're null and nothing is counted.
+ */
+extern "C"
+{
+  void BBFQA_SetAllocCounting(const bool on) __attribute__((weak));
+  void BBFQA_GetAllocCounts(uint64_t* nAllocs, uint64_t* nBytes) __attribute__((weak));
+}
+
+
+
+// ============================================================================
+//! Counter of heap allocations
+// ============================================================================
+/*! Counts the no. of allocations (and bytes requested) made by the
+ *  calling thread through operator new while counting is switched on.
+ *  Counts are cumulative, so a stage is measured by reading them before
+ *  and after it, e.g.
+ *
+ *    AllocationCounter::Start();
+ *    const AllocationCounter::Counts before = AllocationCounter::Read();
+ *    ...
+ *    counts += AllocationCounter::Read() - before;
+ *    AllocationCounter::Stop();
+ */
+class AllocationCounter
+{
+
+  public:
+
+    // ========================================================================
+    //! Allocations and bytes
+    // ========================================================================
+    struct Counts
+    {
+      uint64_t nAllocs = 0;
+      uint64_t nBytes  = 0;
+
+      Counts operator-(const Counts& rhs) const
+      {
+        return {nAllocs - rhs.nAllocs, nBytes - rhs.nBytes};
+      }
+
+      Counts& operator+=(const Counts& rhs)
+      {
+        nAllocs += rhs.nAllocs;
+        nBytes  += rhs.nBytes;
+        return *this;
+      }
+    };
+
+    ///! check if the hooks are loaded
+    static bool IsAvailable()
+    {
+      return (BBFQA_SetAllocCounting != nullptr) && (BBFQA_GetAllocCounts != nullptr);
+    }
+
+    ///! switch counting on/off for the calling thread
+    static void Start() {if (IsAvailable()) BBFQA_SetAllocCounting(true);}
+    static void Stop()  {if (IsAvailable()) BBFQA_SetAllocCounting(false);}
+
+    ///! read cumulative counts of the calling thread
+    static Counts Read()
+    {
+      Counts counts;
+      if (IsAvailable())
+      {
+        BBFQA_GetAllocCounts(&counts.nAllocs, &counts.nBytes);
+      }
+      return counts;
+    }
+
+};  // end AllocationCounter
+
+#endif
+
+// end ========================================================================
@@ -0,0 +1,113 @@
+/// ===========================================================================
+/*! \file    AllocationHooks.cc
+ *  \authors Derek Anderson
+ *  \date    10.16.2026
+ *
+ *  Replacements of the global operator new/delete which
+ *  count allocations for AllocationCounter. These are
+ *  built into their own library, which is only meant to
+ *  be preloaded when counting, e.g.
+ *
+ *    LD_PRELOAD=libbeambackgroundfilterandqa_allochooks.so \
+ *      root -b -q Fun4All_TestBeamBackgroundFilterAndQA.C
+ */
+/// ===========================================================================
+
+#define ALLOCATIONHOOKS_CC
+
+// c++ utilities
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+
+
+
+namespace
+{
+
+  // ==========================================================================
+  //! Per-thread counting state
+  // ==========================================================================
+  struct State
+  {
+    bool     active;
+    uint64_t nAllocs;
+    uint64_t nBytes;
+  };
+
+  thread_local State t_state = {false, 0, 0};
+
+
+
+  // --------------------------------------------------------------------------
+  //! Count (if needed) and allocate
+  // --------------------------------------------------------------------------
+  void* Allocate(const std::size_t size, const std::size_t align, const bool doThrow)
+  {
+    if (t_state.active)
+    {
+      ++t_state.nAllocs;
+      t_state.nBytes += size;
+    }
+
+    void* ptr = nullptr;
+    if (align > alignof(std::max_align_t))
+    {
+      if (posix_memalign(&ptr, align, (size > 0) ? size : 1) != 0) ptr = nullptr;
+    }
+    else
+    {
+      ptr = std::malloc((size > 0) ? size : 1);
+    }
+
+    if (!ptr && doThrow) throw std::bad_alloc();
+    return ptr;
+  }
+
+}  // end anonymous namespace
+
+
+
+// ============================================================================
+//! Entry points for AllocationCounter
+// ============================================================================
+extern "C" void BBFQA_SetAllocCounting(const bool on)
+{
+  t_state.active = on;
+}
+
+extern "C" void BBFQA_GetAllocCounts(uint64_t* nAllocs, uint64_t* nBytes)
+{
+  *nAllocs = t_state.nAllocs;
+  *nBytes  = t_state.nBytes;
+}
+
+
+
+// ============================================================================
+//! Replacement operators
+// ============================================================================
+void* operator new(std::size_t size)                                       {return Allocate(size, 0, true);}
+void* operator new[](std::size_t size)                                     {return Allocate(size, 0, true);}
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept       {return Allocate(size, 0, false);}
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept     {return Allocate(size, 0, false);}
+void* operator new(std::size_t size, std::align_val_t align)               {return Allocate(size, static_cast<std::size_t>(align), true);}
+void* operator new[](std::size_t size, std::align_val_t align)             {return Allocate(size, static_cast<std::size_t>(align), true);}
+void* operator new(std::size_t size, std::align_val_t align, const std::nothrow_t&) noexcept   {return Allocate(size, static_cast<std::size_t>(align), false);}
+void* operator new[](std::size_t size, std::align_val_t align, const std::nothrow_t&) noexcept {return Allocate(size, static_cast<std::size_t>(align), false);}
+
+void operator delete(void* ptr) noexcept                                         {std::free(ptr);}
+void operator delete[](void* ptr) noexcept                                       {std::free(ptr);}
+void operator delete(void* ptr, std::size_t) noexcept                            {std::free(ptr);}
+void operator delete[](void* ptr, std::size_t) noexcept                          {std::free(ptr);}
+void operator delete(void* ptr, const std::nothrow_t&) noexcept                  {std::free(ptr);}
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept                {std::free(ptr);}
+void operator delete(void* ptr, std::align_val_t) noexcept                       {std::free(ptr);}
+void operator delete[](void* ptr, std::align_val_t) noexcept                     {std::free(ptr);}
+void operator delete(void* ptr, std::size_t, std::align_val_t) noexcept          {std::free(ptr);}
+void operator delete[](void* ptr, std::size_t, std::align_val_t) noexcept        {std::free(ptr);}
+void operator delete(void* ptr, std::align_val_t, const std::nothrow_t&) noexcept   {std::free(ptr);}
+void operator delete[](void* ptr, std::align_val_t, const std::nothrow_t&) noexcept {std::free(ptr);}
+
+// end ========================================================================
@@ -13,16 +13,32 @@
 #define BASEBEAMBACKGROUNDFILTER_H
 
 // c++ utilities
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <functional>
+#include <iostream>
 #include <map>
+#include <memory>
+#include <set>
 #include <string>
+#include <vector>
 
 // root libraries
 #include <TH1.h>
+#include <TH2.h>
 
 // f4a libraries
 #include <fun4all/Fun4AllReturnCodes.h>
 #include <fun4all/Fun4AllHistoManager.h>
 
+// module components
+#include "BeamBackgroundFilterAndQADefs.h"
+#include "BeamBackgroundFilterAndQALog.h"
+#include "HistAccumulator.h"
+#include "PerfCounters.h"
+#include "StageTrace.h"
+
 // forward declarations
 class PHCompositeNode;
 
@@ -50,17 +66,159 @@ class BaseBeamBackgroundFilter
     //! Histograms
     // ------------------------------------------------------------------------
     /*! All QA histograms for a given filter should be defined in this
-     *  map, e.g.
+     *  map, preferably via BuildHistogram (see below), e.g.
      *
-     *  m_hists["hNStreakPhi"] = new TH2D("hNStreakPhi", "", 64, 0., 64., 10, 0., 10.);
+     *  BuildHistogram("hNStreakPhi", name, {64, 0., 64., 10, 0., 10.});
      */
     std::map<std::string, TH1*> m_hists;
 
+    ///! histograms refused for being over the qa budget
+    std::set<std::string> m_refused;
+
+    ///! qa memory budget (in bytes, 0 = no limit), what to do when
+    ///! it's exceeded, and memory used by histograms (and reserved
+    ///! for their accumulators) so far
+    std::size_t m_histBudget = 0;
+    BeamBackgroundFilterAndQADefs::Budget m_budgetPolicy = BeamBackgroundFilterAndQADefs::Budget::Refuse;
+    std::size_t m_histBytes = 0;
+    std::size_t m_accumulatorBytes = 0;
+
+    // ------------------------------------------------------------------------
+    //! Histogram accumulators
+    // ------------------------------------------------------------------------
+    /*! Histograms should be filled through these rather than directly,
+     *  so that filters can be run from several threads at once. They're
+     *  indexed by a filter-specific enum (i.e. typed handles), and are
+     *  created once by calling BuildAccumulators at the end of
+     *  BuildHistograms with the m_hists keys in enum order, e.g.
+     *
+     *  enum Hist {NStreakPhi};
+     *  ...
+     *  BuildAccumulators({"hNStreakPhi"});
+     *  ...
+     *  GetAccumulator(Hist::NStreakPhi).Fill(iPhi, nStreak);
+     *
+     *  Fills land in the histograms when MergeHistograms is called. These
+     *  count (unit-weight) fills; weighted histograms should get their
+     *  own MakeAccumulator<double>.
+     */
+    std::vector<HistAccumulator<uint64_t>> m_accumulators;
+
+    ///! get accumulator from typed handle
+    template <typename H> HistAccumulator<uint64_t>& GetAccumulator(const H handle)
+    {
+      return m_accumulators[static_cast<std::size_t>(handle)];
+    }
+
+    ///! no. of worker slots for accumulators
+    std::size_t m_nWorkerSlots = 1;
+
     ///! filter name
     std::string m_name;
 
+    ///! whether or not to fill detailed QA histograms for current event
+    ///!   - n.b. off until histograms are built, so a filter without
+    ///!     histograms never touches its fill paths
+    bool m_fillQA = false;
+
+    ///! performance counters to measure internal stages (e.g. map
+    ///! builds) w/ for current event (nullptr = don't measure), and
+    ///! counts for map builds
+    const PerfCounters*  m_perf = nullptr;
+    PerfCounters::Counts m_buildCounts;
+
+    ///! trace to record internal stages (e.g. map builds, candidate
+    ///! scans, qa fills) into (nullptr = don't record)
+    StageTrace* m_trace = nullptr;
+
+    // ------------------------------------------------------------------------
+    //! Logging
+    // ------------------------------------------------------------------------
+    /*! Filters should log through Log rather than std::cout, e.g.
+     *
+     *  Log<bbfql::Trace>("Found ", nStreak, " streaks");
+     *
+     *  Messages go to the module's logger (and so into its event traces)
+     *  if one was set w/ SetLogger, and otherwise to the filter's own,
+     *  which only prints (at or below its print level, see SetLogLevel).
+     *  Levels which aren't compiled in cost nothing.
+     */
+    template <BeamBackgroundFilterAndQALog::Level L, typename... Args> void Log(const Args&... args)
+    {
+      if constexpr (BeamBackgroundFilterAndQALog::IsCompiled<L>())
+      {
+        BeamBackgroundFilterAndQALog::Logger& log = m_sharedLog ? *m_sharedLog : m_ownLog;
+        log.template Log<L>(args...);
+      }
+      return;
+    }
+
+    ///! set print level of the filter's own logger
+    void SetLogLevel(const BeamBackgroundFilterAndQALog::Level level) {m_ownLog.SetPrintLevel(level);}
+
+    ///! the filter's own logger, and the module's (nullptr = use own)
+    BeamBackgroundFilterAndQALog::Logger  m_ownLog = BeamBackgroundFilterAndQALog::Logger(BeamBackgroundFilterAndQALog::Warn, BeamBackgroundFilterAndQALog::Off, 1);
+    BeamBackgroundFilterAndQALog::Logger* m_sharedLog = nullptr;
+
   public:
 
+    ///! signature of functions which create a filter
+    typedef std::function<
+      std::unique_ptr<BaseBeamBackgroundFilter>(
+        const std::string& name,
+        const BeamBackgroundFilterAndQADefs::Parameters& params
+      )
+    > Factory;
+
+    // ------------------------------------------------------------------------
+    //! Filter registry
+    // ------------------------------------------------------------------------
+    /*! Maps filter types onto factories which create them. Each filter
+     *  should add itself here (see RegisterFilter) so that only the ones
+     *  which are actually used ever get instantiated.
+     */
+    static std::map<std::string, Factory>& Registry()
+    {
+      static std::map<std::string, Factory> registry;
+      return registry;
+    }
+
+    // ------------------------------------------------------------------------
+    //! Register a filter type
+    // ------------------------------------------------------------------------
+    /*! Should be called once per filter type, e.g. from a static variable
+     *  in the filter's .cc file:
+     *
+     *  const bool registered = BaseBeamBackgroundFilter::RegisterFilter(
+     *    "Null",
+     *    [](const std::string& name, const bbfqd::Parameters& params) {...}
+     *  );
+     */
+    static bool RegisterFilter(const std::string& type, Factory factory)
+    {
+      return Registry().emplace(type, std::move(factory)).second;
+    }
+
+    // ------------------------------------------------------------------------
+    //! Create a registered filter
+    // ------------------------------------------------------------------------
+    /*! Returns a null pointer if no filter of the given type has been
+     *  registered.
+     */
+    static std::unique_ptr<BaseBeamBackgroundFilter> CreateFilter(
+      const std::string& type,
+      const std::string& name,
+      const BeamBackgroundFilterAndQADefs::Parameters& params = {}
+    ) {
+      auto factory = Registry().find(type);
+      if (factory == Registry().end())
+      {
+        std::cerr << "BaseBeamBackgroundFilter::CreateFilter() WARNING: no filter of type '" << type << "' registered!" << std::endl;
+        return nullptr;
+      }
+      return factory->second(name, params);
+    }
+
     // ------------------------------------------------------------------------
     //! Apply filter
     // ------------------------------------------------------------------------
@@ -69,6 +227,40 @@ class BaseBeamBackgroundFilter
      */
     virtual bool ApplyFilter(PHCompositeNode* /*topNode*/) {return false;}
 
+    // ------------------------------------------------------------------------
+    //! Apply filter to a snapshot of an event
+    // ------------------------------------------------------------------------
+    /*! Applies the filter to an already-built snapshot of an event's
+     *  towers, i.e. without touching the node tree. Should return true
+     *  if filter finds beam background, and false if not.
+     */
+    virtual bool ApplyFilterToSnapshot(const BeamBackgroundFilterAndQADefs::TowerSnapshot& /*snapshot*/) {return false;}
+
+    // ------------------------------------------------------------------------
+    //! Apply filter to a batch of events
+    // ------------------------------------------------------------------------
+    /*! Applies the filter to nEvents event snapshots, and writes one
+     *  decision (1 if the filter finds beam background, 0 if not) per
+     *  event into decisions, which has to hold at least nEvents. Since
+     *  both are plain arrays, any sub-range of a caller's buffers can be
+     *  passed, and separate ranges of the output can be written from
+     *  different threads. The default simply loops over the events in
+     *  order; filters are free to override this with something smarter
+     *  (e.g. processing several events in parallel), so long as state
+     *  kept across events (e.g. hot-tower masks) stays in event order.
+     */
+    virtual void ApplyFilterToBatch(
+      const BeamBackgroundFilterAndQADefs::TowerSnapshot* snapshots,
+      const std::size_t nEvents,
+      uint8_t* decisions
+    ) {
+      for (std::size_t iEvt = 0; iEvt < nEvents; ++iEvt)
+      {
+        decisions[iEvt] = ApplyFilterToSnapshot( snapshots[iEvt] );
+      }
+      return;
+    }
+
     // ------------------------------------------------------------------------
     //! Build associated histograms
     // ------------------------------------------------------------------------
@@ -76,6 +268,155 @@ class BaseBeamBackgroundFilter
      */ 
     virtual void BuildHistograms(const std::string& /*module*/, const std::string& /*tag*/) {return;}
 
+    // ------------------------------------------------------------------------
+    //! Create a QA histogram within the memory budget
+    // ------------------------------------------------------------------------
+    /*! Creates a 1D (binning.nBinsY = 0) or 2D histogram and adds it to
+     *  m_hists under key. Histograms of counts use integer storage. The
+     *  budget covers both the histogram and its accumulator (one copy of
+     *  the bins per worker slot, see MakeAccumulator). If the pair would
+     *  push the filter over its budget, the histogram is either refused
+     *  (and nullptr is returned) or downsampled by halving the no. of bins
+     *  until it fits, depending on the budget policy. Either way, fills
+     *  of its accumulator still work.
+     */
+    inline TH1* BuildHistogram(
+      const std::string& key,
+      const std::string& name,
+      const HistBinning& binning,
+      const bool isCount = true
+    ) {
+
+      // check histogram + accumulator against budget
+      const std::size_t cellBytes = isCount ? sizeof(Int_t) : sizeof(Double_t);
+      auto getAccumulatorBytes = [&](const HistBinning& bins)
+      {
+        return isCount ? HistAccumulator<uint64_t>::GetBytes(bins, m_nWorkerSlots)
+                       : HistAccumulator<double>::GetBytes(bins, m_nWorkerSlots);
+      };
+      auto getBytes = [&](const HistBinning& bins)
+      {
+        return (bins.GetNCells() * cellBytes) + getAccumulatorBytes(bins);
+      };
+      auto isOverBudget = [&](const HistBinning& bins)
+      {
+        return (m_histBudget > 0) && ((m_histBytes + m_accumulatorBytes + getBytes(bins)) > m_histBudget);
+      };
+
+      // if needed, downsample
+      HistBinning toBuild = binning;
+      if (isOverBudget(toBuild) && (m_budgetPolicy == BeamBackgroundFilterAndQADefs::Budget::Downsample))
+      {
+        while (isOverBudget(toBuild) && ((toBuild.nBinsX > 1) || (toBuild.nBinsY > 1)))
+        {
+          toBuild.nBinsX = std::max<std::size_t>(toBuild.nBinsX / 2, 1);
+          toBuild.nBinsY = (toBuild.nBinsY > 0) ? std::max<std::size_t>(toBuild.nBinsY / 2, 1) : 0;
+        }
+      }
+
+      // and refuse if it still doesn't fit
+      if (isOverBudget(toBuild))
+      {
+        std::cout << "BaseBeamBackgroundFilter::BuildHistogram() WARNING: histogram '" << name << "' exceeds QA budget of filter " << m_name << ", not creating it" << std::endl;
+        m_refused.insert(key);
+        return nullptr;
+      }
+      if (!(toBuild == binning))
+      {
+        std::cout << "BaseBeamBackgroundFilter::BuildHistogram() WARNING: downsampled histogram '" << name << "' to fit QA budget of filter " << m_name << std::endl;
+      }
+
+      // create histogram
+      TH1* hist = nullptr;
+      if (toBuild.nBinsY == 0)
+      {
+        if (isCount)
+          hist = new TH1I(name.data(), "", toBuild.nBinsX, toBuild.xMin, toBuild.xMax);
+        else
+          hist = new TH1D(name.data(), "", toBuild.nBinsX, toBuild.xMin, toBuild.xMax);
+      }
+      else
+      {
+        if (isCount)
+          hist = new TH2I(name.data(), "", toBuild.nBinsX, toBuild.xMin, toBuild.xMax, toBuild.nBinsY, toBuild.yMin, toBuild.yMax);
+        else
+          hist = new TH2D(name.data(), "", toBuild.nBinsX, toBuild.xMin, toBuild.xMax, toBuild.nBinsY, toBuild.yMin, toBuild.yMax);
+      }
+      m_hists[key] = hist;
+      m_histBytes        += toBuild.GetNCells() * cellBytes;
+      m_accumulatorBytes += getAccumulatorBytes(toBuild);
+      m_fillQA     = true;
+      return hist;
+
+    }  // end 'BuildHistogram(std::string&, std::string&, HistBinning&, bool)'
+
+    // ------------------------------------------------------------------------
+    //! Make an accumulator for a histogram
+    // ------------------------------------------------------------------------
+    /*! Fills with the binning the histogram was actually built w/ (i.e.
+     *  downsampled, if it was), so any precomputed bin numbers should be
+     *  taken from the accumulator (e.g. via FindBin) after it's made. If
+     *  the histogram was refused, the accumulator is disabled (and fills
+     *  do nothing).
+     */
+    template <typename T = uint64_t> HistAccumulator<T> MakeAccumulator(const std::string& key)
+    {
+      auto hist = m_hists.find(key);
+      if (hist == m_hists.end())
+      {
+        if (m_refused.find(key) == m_refused.end())
+        {
+          std::cerr << "BaseBeamBackgroundFilter::MakeAccumulator() PANIC! No histogram '" << key << "' in filter " << m_name << "!" << std::endl;
+          assert(m_refused.find(key) != m_refused.end());
+        }
+        return HistAccumulator<T>();
+      }
+      return HistAccumulator<T>(hist->second, m_nWorkerSlots);
+    }
+
+    // ------------------------------------------------------------------------
+    //! Create accumulators for histograms
+    // ------------------------------------------------------------------------
+    /*! Accumulators are created in the order of the provided keys, which
+     *  should match the filter's histogram enum. Keys which don't match a
+     *  histogram in m_hists are caught here, rather than at fill time.
+     */
+    inline void BuildAccumulators(const std::vector<std::string>& keys)
+    {
+      m_accumulators.clear();
+      for (const std::string& key : keys)
+      {
+        m_accumulators.push_back( MakeAccumulator(key) );
+      }
+      return;
+    }
+
+    // ------------------------------------------------------------------------
+    //! Get memory used for QA
+    // ------------------------------------------------------------------------
+    /*! Returns memory used by histograms and accumulators (in bytes).
+     *  Filters with additional accumulators should add them here.
+     */
+    virtual std::size_t GetQABytes() const
+    {
+      std::size_t bytes = m_histBytes;
+      for (const auto& accumulator : m_accumulators)
+      {
+        bytes += accumulator.GetBytes();
+      }
+      return bytes;
+    }
+
+    ///! add accumulated fills to histograms
+    virtual void MergeHistograms()
+    {
+      for (auto& accumulator : m_accumulators)
+      {
+        accumulator.Merge();
+      }
+      return;
+    }
+
     ///! register histograms
     inline void RegisterHistograms(Fun4AllHistoManager* manager)
     {
@@ -86,12 +427,40 @@ class BaseBeamBackgroundFilter
       return;
     }
 
+    ///! Set no. of threads which may fill histograms at once (call before BuildHistograms)
+    void SetNWorkerSlots(const std::size_t nSlots) {m_nWorkerSlots = nSlots;}
+
+    ///! Set QA memory budget (in bytes, 0 = no limit) and what to do when it's exceeded (call before BuildHistograms)
+    void SetHistBudget(const std::size_t bytes, const BeamBackgroundFilterAndQADefs::Budget policy)
+    {
+      m_histBudget   = bytes;
+      m_budgetPolicy = policy;
+    }
+
+    ///! Turn filling of detailed QA histograms on/off (e.g. for prescaling; does nothing if histograms weren't built)
+    void SetFillQA(const bool fill) {m_fillQA = fill && !m_hists.empty();}
+
+    ///! Set performance counters to measure internal stages w/ for current event (nullptr = don't measure)
+    void SetPerfCounters(const PerfCounters* perf) {m_perf = perf;}
+
+    ///! Set trace to record internal stages into (nullptr = don't record)
+    void SetStageTrace(StageTrace* trace) {m_trace = trace;}
+
+    ///! Set logger to log into, e.g. the module's (nullptr = use the filter's own)
+    void SetLogger(BeamBackgroundFilterAndQALog::Logger* log) {m_sharedLog = log;}
+
+    ///! Get performance counts of map builds (if any were measured)
+    const PerfCounters::Counts& GetBuildCounts() const {return m_buildCounts;}
+
     ///! Set filter name
     void SetName(const std::string& name) {m_name = name;}
 
     ///! Get filter name
     std::string GetName() {return m_name;}
 
+    ///! Get histograms (keyed by variable name)
+    const std::map<std::string, TH1*>& GetHistograms() const {return m_hists;}
+
     ///! default ctor/dtor
     BaseBeamBackgroundFilter()  {};
     virtual ~BaseBeamBackgroundFilter() {};
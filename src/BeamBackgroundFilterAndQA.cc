@@ -12,7 +12,10 @@
 #define BEAMBACKGROUNDFILTERANDQA_CC
 
 // c++ utiilites
+#include <algorithm>
 #include <cassert>
+#include <chrono>
+#include <cmath>
 #include <iostream>
 
 // calo base
@@ -21,6 +24,7 @@
 // f4a libraries
 #include <fun4all/Fun4AllReturnCodes.h>
 #include <fun4all/Fun4AllHistoManager.h>
+#include <ffaobjects/EventHeader.h>
 #include <ffaobjects/FlagSavev1.h>
 
 // phool libraries
@@ -38,9 +42,11 @@
 // module components
 #include "BeamBackgroundFilterAndQA.h"
 #include "BeamBackgroundFilterAndQADefs.h"
+#include "QASidecar.h"
 
-// alias for convenience
+// aliases for convenience
 namespace bbfqd = BeamBackgroundFilterAndQADefs;
+namespace bbfql = BeamBackgroundFilterAndQALog;
 
 
 
@@ -51,6 +57,13 @@ namespace bbfqd = BeamBackgroundFilterAndQADefs;
 // ----------------------------------------------------------------------------
 BeamBackgroundFilterAndQA::BeamBackgroundFilterAndQA(const std::string& name, const bool debug)
   : SubsysReco(name)
+  , m_manager(nullptr)
+  , m_consts(nullptr)
+  , m_countAllocs(false)
+  , m_countAllocsThisEvt(false)
+  , m_nAllocEvts(0)
+  , m_nEvtsSeen(0)
+  , m_lastSnapshotEvt(0)
 {
 
   // print debug message
@@ -70,6 +83,11 @@ BeamBackgroundFilterAndQA::BeamBackgroundFilterAndQA(const Config& config)
   : SubsysReco(config.moduleName)
   , m_manager(nullptr)
   , m_consts(nullptr)
+  , m_countAllocs(false)
+  , m_countAllocsThisEvt(false)
+  , m_nAllocEvts(0)
+  , m_nEvtsSeen(0)
+  , m_lastSnapshotEvt(0)
   , m_config(config)
 {
 
@@ -114,17 +132,52 @@ int BeamBackgroundFilterAndQA::Init(PHCompositeNode* /*topNode*/)
     std::cout << "BeamBackgroundFilterAndQA::Init(PHCompositeNode *topNode) Initializing" << std::endl;
   }
 
-  // initialize relevant filters, histograms
+  // initialize logger
+  m_log = bbfql::Logger(m_config.printLevel, m_config.traceLevel, m_config.nLogTraces);
+
+  // initialize relevant filters
   InitFilters();
   InitFlags();
-  BuildHistograms();
 
   // if needed, initialize histograms + manager
+  //   - n.b. if not doing qa, no histograms are
+  //     created and nothing gets filled
   if (m_config.doQA)
   {
+    BuildHistograms();
+    if (m_config.reportQAFootprint)
+    {
+      ReportQAFootprint();
+    }
     InitHistManager();
     RegisterHistograms();
   }
+
+  // if needed, open hardware counters
+  if (m_config.perfPrescale > 0)
+  {
+    InitPerfCounters();
+  }
+
+  // if needed, set up allocation counting
+  //   - n.b. asserting w/o being able to count is
+  //     fatal even if asserts are compiled out
+  if ((m_config.countAllocs || m_config.assertNoAllocs) && !InitAllocCounter())
+  {
+    return Fun4AllReturnCodes::ABORTRUN;
+  }
+
+  // if needed, start tracing
+  if (!m_config.traceFile.empty())
+  {
+    InitTrace();
+  }
+
+  // if needed, start writing online snapshots
+  if (!m_config.snapshotFile.empty())
+  {
+    InitSnapshots();
+  }
   return Fun4AllReturnCodes::EVENT_OK;
 
 }  // end 'Init(PHCompositeNode*)'
@@ -137,13 +190,32 @@ int BeamBackgroundFilterAndQA::Init(PHCompositeNode* /*topNode*/)
 int BeamBackgroundFilterAndQA::process_event(PHCompositeNode* topNode)
 {
 
-  if (m_config.debug)
+  // if needed, start counting allocations
+  AllocationCounter::Counts allocStart;
+  m_countAllocsThisEvt = m_countAllocs && (m_nEvtsSeen >= m_config.nAllocWarmUp);
+  if (m_countAllocsThisEvt)
+  {
+    AllocationCounter::Start();
+    allocStart = AllocationCounter::Read();
+  }
+
+  // start trace for this event
+  m_log.BeginEvent(m_nEvtsSeen);
+  if (m_trace.IsOpen())
   {
-    std::cout << "BeamBackgroundFilterAndQA::process_event(PHCompositeNode *topNode) Processing event" << std::endl;
+    m_trace.SetEvent(m_nEvtsSeen);
   }
+  m_log.Log<bbfql::Debug>("BeamBackgroundFilterAndQA::process_event(PHCompositeNode *topNode) Processing event");
 
   // check for beam background
   const bool hasBeamBkgd = ApplyFilters(topNode);
+  ++m_nEvtsSeen;
+
+  // if needed, take an online snapshot
+  if (m_snapshotWriter)
+  {
+    UpdateSnapshot();
+  }
 
   // if debugging, print out flags
   if (m_config.debug)
@@ -152,14 +224,21 @@ int BeamBackgroundFilterAndQA::process_event(PHCompositeNode* topNode)
   }
 
   // if it does, abort event
+  int status = Fun4AllReturnCodes::EVENT_OK;
   if (hasBeamBkgd && m_config.doEvtAbort)
   {
-    return Fun4AllReturnCodes::ABORTEVENT;
+    m_log.Log<bbfql::Debug>("BeamBackgroundFilterAndQA::process_event(PHCompositeNode *topNode) Aborting event with beam background");
+    status = Fun4AllReturnCodes::ABORTEVENT;
   }
-  else
+
+  // if counting allocations, stop and check them (and dump
+  // the last few event traces if the run is aborted)
+  if (m_countAllocsThisEvt && !FinishAllocCount(allocStart))
   {
-    return Fun4AllReturnCodes::EVENT_OK;
+    m_log.Dump();
+    status = Fun4AllReturnCodes::ABORTRUN;
   }
+  return status;
 
 }  // end 'process_event(PHCompositeNode*)'
 
@@ -176,13 +255,99 @@ int BeamBackgroundFilterAndQA::End(PHCompositeNode* /*topNode*/)
     std::cout << "BeamBackgroundFilterAndQA::End(PHCompositeNode *topNode) This is the end..." << std::endl;
   }
 
-  //... nothing to do ...//
+  // add accumulated fills to histograms
+  MergeHistograms();
+
+  // if timing, summarize filter latencies
+  if (m_config.doQA && (m_config.timingPrescale > 0))
+  {
+    PrintLatencySummary();
+  }
+
+  // if counting, summarize allocations
+  if (m_countAllocs)
+  {
+    PrintAllocSummary();
+  }
+
+  // if counting, summarize hardware counts
+  if (m_perf.IsOpen())
+  {
+    PrintPerfSummary();
+    m_perf.Close();
+  }
+
+  // if needed, write out sidecar
+  if (m_config.doQA && !m_config.qaSidecarFile.empty())
+  {
+    WriteSidecar();
+  }
+
+  // if tracing, write out timeline
+  if (m_trace.IsOpen())
+  {
+    WriteTrace();
+  }
+
+  // write final snapshot
+  if (m_snapshotWriter)
+  {
+    FillSnapshot();
+    m_snapshotWriter->Finish(m_snapshot);
+    m_snapshotWriter.reset();
+  }
+
+  // if needed, dump last few event traces
+  if (m_config.dumpTracesAtEnd)
+  {
+    m_log.Dump();
+  }
   return Fun4AllReturnCodes::EVENT_OK;
 
 }  // end 'End(PHCompositeNode*)'
 
 
 
+// public methods =============================================================
+
+// ----------------------------------------------------------------------------
+//! Add accumulated fills to histograms
+// ----------------------------------------------------------------------------
+/*! Called at End, but can also be called at any point between events
+ *  (e.g. to checkpoint QA) as long as no filters are running.
+ */
+void BeamBackgroundFilterAndQA::MergeHistograms()
+{
+
+  // print debug message
+  if (m_config.debug && (Verbosity() > 0))
+  {
+    std::cout << "BeamBackgroundFilterAndQA::MergeHistograms() Merging accumulated fills into histograms" << std::endl;
+  }
+
+  // merge module-wide histograms
+  m_nEvtsOverall.Merge();
+  m_qaSampling.Merge();
+  for (auto& accumulator : m_nEvtsPerFilter)
+  {
+    accumulator.Merge();
+  }
+  for (auto& accumulator : m_latencyPerFilter)
+  {
+    accumulator.Merge();
+  }
+
+  // merge filter-specific histograms
+  for (auto& filter : m_filters)
+  {
+    filter.second->MergeHistograms();
+  }
+  return;
+
+}  // end 'MergeHistograms()'
+
+
+
 // private methods ============================================================
 
 // ----------------------------------------------------------------------------
@@ -197,9 +362,41 @@ void BeamBackgroundFilterAndQA::InitFilters()
     std::cout << "BeamBackgroundFilterAndQA::InitFilters() Initializing background filters" << std::endl;
   }
 
-  m_filters["Null"] = std::make_unique<NullFilter>( m_config.null, "Null" );
-  m_filters["StreakSideband"] = std::make_unique<StreakSidebandFilter>( m_config.sideband, "StreakSideband" );
-  //... other filters added here ...//
+  // drop repeated filters, so that each is only created (and
+  // flagged) once
+  std::vector<std::string> uniqueFilters;
+  for (const std::string& filterToApply : m_config.filtersToApply)
+  {
+    if (std::find(uniqueFilters.begin(), uniqueFilters.end(), filterToApply) != uniqueFilters.end())
+    {
+      std::cerr << PHWHERE << ": WARNING: filter '" << filterToApply << "' is listed more than once, only applying it once" << std::endl;
+      continue;
+    }
+    uniqueFilters.push_back(filterToApply);
+  }
+  m_config.filtersToApply = uniqueFilters;
+
+  // only instantiate the filters which will be used
+  for (const std::string& filterToApply : m_config.filtersToApply)
+  {
+
+    // grab parameters, if any were provided
+    bbfqd::Parameters params;
+    if (m_config.filterParams.count(filterToApply))
+    {
+      params = m_config.filterParams.at(filterToApply);
+    }
+
+    // and create filter from registry
+    m_filters[filterToApply] = BaseBeamBackgroundFilter::CreateFilter(filterToApply, filterToApply, params);
+    if (!m_filters[filterToApply])
+    {
+      std::cerr << PHWHERE << ": PANIC! Unknown filter '" << filterToApply << "'!" << std::endl;
+      assert(m_filters[filterToApply]);
+    }
+    m_filters[filterToApply]->SetLogger(&m_log);
+    m_filtersToApply.push_back(m_filters[filterToApply].get());
+  }
   return;
 
 }  // end 'InitFilters()'
@@ -221,7 +418,8 @@ void BeamBackgroundFilterAndQA::InitFlags()
   m_consts = recoConsts::instance();
   for (const std::string& filterToApply : m_config.filtersToApply)
   {
-    m_consts->set_IntFlag("HasBeamBackground_" + filterToApply + "Filter", 0);
+    m_flagNames.push_back("HasBeamBackground_" + filterToApply + "Filter");
+    m_consts->set_IntFlag(m_flagNames.back(), 0);
   }
   m_consts->set_IntFlag("HasBeamBackground", 0);
   return;
@@ -254,6 +452,128 @@ void BeamBackgroundFilterAndQA::InitHistManager()
 
 
 
+// ----------------------------------------------------------------------------
+//! Initialize online snapshots
+// ----------------------------------------------------------------------------
+/*! Counts for snapshots are kept separately from the nevts histograms,
+ *  so that they're available whether or not QA is being done.
+ */
+void BeamBackgroundFilterAndQA::InitSnapshots()
+{
+
+  // print debug message
+  if (m_config.debug && (Verbosity() > 0))
+  {
+    std::cout << "BeamBackgroundFilterAndQA::InitSnapshots() Initializing online snapshots" << std::endl;
+  }
+
+  // overall counts go first, then each filter
+  m_snapshotNames = {"overall"};
+  for (const std::string& filterToApply : m_config.filtersToApply)
+  {
+    m_snapshotNames.push_back(filterToApply);
+  }
+  m_snapshotCounts.assign(m_snapshotNames.size(), {0, 0, 0});
+
+  // start writer and clock, sizing all three snapshot buffers
+  // up front so that taking snapshots (which happens inside the
+  // allocation-counting window) never allocates
+  m_startTime        = std::chrono::steady_clock::now();
+  FillSnapshot();
+  m_snapshotWriter   = std::make_unique<QASnapshotWriter>(m_config.snapshotFile, m_snapshot);
+  m_lastSnapshotTime = m_startTime;
+  m_lastSnapshotEvt  = 0;
+  return;
+
+}  // end 'InitSnapshots()'
+
+
+
+// ----------------------------------------------------------------------------
+//! Initialize hardware counters
+// ----------------------------------------------------------------------------
+void BeamBackgroundFilterAndQA::InitPerfCounters()
+{
+
+  // print debug message
+  if (m_config.debug && (Verbosity() > 0))
+  {
+    std::cout << "BeamBackgroundFilterAndQA::InitPerfCounters() Opening hardware counters" << std::endl;
+  }
+
+  m_perfPerFilter.assign(m_config.filtersToApply.size(), PerfCounters::Counts());
+  if (!m_perf.Open())
+  {
+    std::cerr << PHWHERE << ": WARNING: hardware counters unavailable (check perf_event_paranoid), continuing without them" << std::endl;
+  }
+  return;
+
+}  // end 'InitPerfCounters()'
+
+
+
+// ----------------------------------------------------------------------------
+//! Initialize allocation counting
+// ----------------------------------------------------------------------------
+/*! Returns false if asked to assert no allocations, but the allocation
+ *  hooks aren't loaded (so nothing could be checked).
+ */
+bool BeamBackgroundFilterAndQA::InitAllocCounter()
+{
+
+  // print debug message
+  if (m_config.debug && (Verbosity() > 0))
+  {
+    std::cout << "BeamBackgroundFilterAndQA::InitAllocCounter() Setting up allocation counting" << std::endl;
+  }
+
+  // without the hooks there's nothing to count, which
+  // is only ok if not asserting
+  if (!AllocationCounter::IsAvailable())
+  {
+    if (m_config.assertNoAllocs)
+    {
+      std::cerr << PHWHERE << ": PANIC! Asked to assert no allocations, but allocation hooks aren't loaded! (Preload libbeambackgroundfilterandqa_allochooks.so)" << std::endl;
+      assert(AllocationCounter::IsAvailable());
+      return false;
+    }
+    std::cerr << PHWHERE << ": WARNING: allocation hooks aren't loaded (preload libbeambackgroundfilterandqa_allochooks.so), continuing without counting" << std::endl;
+    return true;
+  }
+
+  m_countAllocs = true;
+  m_allocsPerFilter.assign(m_config.filtersToApply.size(), AllocationCounter::Counts());
+  return true;
+
+}  // end 'InitAllocCounter()'
+
+
+
+// ----------------------------------------------------------------------------
+//! Initialize trace of filter stages
+// ----------------------------------------------------------------------------
+/*! Buffers are allocated here, so that recording spans never allocates.
+ */
+void BeamBackgroundFilterAndQA::InitTrace()
+{
+
+  // print debug message
+  if (m_config.debug && (Verbosity() > 0))
+  {
+    std::cout << "BeamBackgroundFilterAndQA::InitTrace() Allocating trace buffers" << std::endl;
+  }
+
+  m_trace.Open(m_config.nWorkerSlots, m_config.traceCapacity);
+  for (BaseBeamBackgroundFilter* filter : m_filtersToApply)
+  {
+    filter->SetStageTrace(&m_trace);
+  }
+  return;
+
+}  // end 'InitTrace()'
+
+
+
 // ----------------------------------------------------------------------------
 //! Build histograms
 // ----------------------------------------------------------------------------
@@ -279,15 +599,59 @@ void BeamBackgroundFilterAndQA::BuildHistograms()
   // create module-wide histograms
   for (std::size_t iVar = 0; iVar < varNames.size(); ++iVar)
   {
-    m_hists[varNames[iVar]] = new TH1D(histNames[iVar].data(), "", 3, -0.5, 2.5);
+    m_hists[varNames[iVar]] = new TH1I(histNames[iVar].data(), "", 3, -0.5, 2.5);
     m_hists[varNames[iVar]]->GetXaxis()->SetBinLabel(1, "All");
     m_hists[varNames[iVar]]->GetXaxis()->SetBinLabel(2, "No beam bkgd.");
     m_hists[varNames[iVar]]->GetXaxis()->SetBinLabel(3, "Beam bkgd.");
   }
 
+  // create histogram to record qa sampling, so that
+  // sampled qa can be renormalized
+  //   - n.b. the sampled fraction is the ratio of
+  //     the 2nd to the 1st bin
+  const std::string samplingName = bbfqd::MakeQAHistNames({"qasampling"}, m_config.moduleName, m_config.histTag).front();
+  m_hists["qasampling"] = new TH1I(samplingName.data(), "", 2, -0.5, 1.5);
+  m_hists["qasampling"]->GetXaxis()->SetBinLabel(1, "All");
+  m_hists["qasampling"]->GetXaxis()->SetBinLabel(2, "QA filled");
+
+  // if timing, create histograms of filter latencies
+  //   - n.b. these are binned in log10(t / ns) from
+  //     10 ns to 100 ms, i.e. 10 bins per decade
+  if (m_config.timingPrescale > 0)
+  {
+    for (const std::string& filterToApply : m_config.filtersToApply)
+    {
+      const std::string latencyName = bbfqd::MakeQAHistNames({"latency_" + filterToApply}, m_config.moduleName, m_config.histTag).front();
+      m_hists["latency_" + filterToApply] = new TH1I(latencyName.data(), "", 70, 1., 8.);
+      m_hists["latency_" + filterToApply]->GetXaxis()->SetTitle("log_{10}(t_{filter} / ns)");
+    }
+  }
+
+  // create accumulators to fill module-wide histograms
+  //   - n.b. per-filter ones follow order of filtersToApply
+  m_nEvtsOverall = HistAccumulator<uint64_t>(m_hists.at("nevts_overall"), m_config.nWorkerSlots);
+  m_qaSampling   = HistAccumulator<uint64_t>(m_hists.at("qasampling"), m_config.nWorkerSlots);
+  m_nEvtsPerFilter.clear();
+  for (const std::string& filterToApply : m_config.filtersToApply)
+  {
+    m_nEvtsPerFilter.emplace_back(m_hists.at("nevts_" + filterToApply), m_config.nWorkerSlots);
+  }
+  m_latencyPerFilter.clear();
+  if (m_config.timingPrescale > 0)
+  {
+    for (const std::string& filterToApply : m_config.filtersToApply)
+    {
+      m_latencyPerFilter.emplace_back(m_hists.at("latency_" + filterToApply), m_config.nWorkerSlots);
+    }
+  }
+  m_latencySum.assign(m_config.filtersToApply.size(), 0.);
+  m_nLatency.assign(m_config.filtersToApply.size(), 0);
+
   // build filter-specific histograms
   for (const std::string& filterToApply : m_config.filtersToApply)
   {
+    m_filters.at(filterToApply)->SetNWorkerSlots(m_config.nWorkerSlots);
+    m_filters.at(filterToApply)->SetHistBudget(m_config.qaBudget, m_config.qaBudgetPolicy);
     m_filters.at(filterToApply)->BuildHistograms(m_config.moduleName, m_config.histTag);
   }
   return;
@@ -296,6 +660,51 @@ void BeamBackgroundFilterAndQA::BuildHistograms()
 
 
 
+// ----------------------------------------------------------------------------
+//! Report memory used for QA
+// ----------------------------------------------------------------------------
+void BeamBackgroundFilterAndQA::ReportQAFootprint()
+{
+
+  // print debug message
+  if (m_config.debug && (Verbosity() > 0))
+  {
+    std::cout << "BeamBackgroundFilterAndQA::ReportQAFootprint() Reporting QA memory footprint" << std::endl;
+  }
+
+  // tally up module-wide histograms
+  //   - n.b. these all use integer storage
+  std::size_t moduleBytes = m_nEvtsOverall.GetBytes() + m_qaSampling.GetBytes();
+  for (const auto& accumulator : m_nEvtsPerFilter)
+  {
+    moduleBytes += accumulator.GetBytes();
+  }
+  for (const auto& accumulator : m_latencyPerFilter)
+  {
+    moduleBytes += accumulator.GetBytes();
+  }
+  for (const auto& hist : m_hists)
+  {
+    moduleBytes += hist.second->GetNcells() * sizeof(Int_t);
+  }
+
+  // print footprint of module and each filter
+  std::size_t totalBytes = moduleBytes;
+  std::cout << "BeamBackgroundFilterAndQA::ReportQAFootprint() QA memory footprint:\n"
+            << "    module-wide = " << moduleBytes / 1024. << " kB" << std::endl;
+  for (const std::string& filterToApply : m_config.filtersToApply)
+  {
+    const std::size_t filterBytes = m_filters.at(filterToApply)->GetQABytes();
+    std::cout << "    " << filterToApply << " = " << filterBytes / 1024. << " kB" << std::endl;
+    totalBytes += filterBytes;
+  }
+  std::cout << "    total = " << totalBytes / 1024. << " kB" << std::endl;
+  return;
+
+}  // end 'ReportQAFootprint()'
+
+
+
 // ----------------------------------------------------------------------------
 //! Register histograms
 // ----------------------------------------------------------------------------
@@ -325,6 +734,80 @@ void BeamBackgroundFilterAndQA::RegisterHistograms()
 
 
 
+// ----------------------------------------------------------------------------
+//! Write QA histograms to a sidecar
+// ----------------------------------------------------------------------------
+void BeamBackgroundFilterAndQA::WriteSidecar()
+{
+
+  // print debug message
+  if (m_config.debug && (Verbosity() > 0))
+  {
+    std::cout << "BeamBackgroundFilterAndQA::WriteSidecar() Writing QA sidecar" << std::endl;
+  }
+
+  // collect module-wide and filter-specific histograms
+  std::vector<TH1*> hists;
+  for (const auto& hist : m_hists)
+  {
+    hists.push_back(hist.second);
+  }
+  for (const std::string& filterToApply : m_config.filtersToApply)
+  {
+    for (const auto& hist : m_filters.at(filterToApply)->GetHistograms())
+    {
+      hists.push_back(hist.second);
+    }
+  }
+
+  if (!QASidecar::Write(m_config.qaSidecarFile, hists))
+  {
+    std::cerr << PHWHERE << ": WARNING: couldn't write QA sidecar to '" << m_config.qaSidecarFile << "'!" << std::endl;
+  }
+  return;
+
+}  // end 'WriteSidecar()'
+
+
+
+// ----------------------------------------------------------------------------
+//! Write trace of filter stages
+// ----------------------------------------------------------------------------
+void BeamBackgroundFilterAndQA::WriteTrace()
+{
+
+  // print debug message
+  if (m_config.debug && (Verbosity() > 0))
+  {
+    std::cout << "BeamBackgroundFilterAndQA::WriteTrace() Writing trace to " << m_config.traceFile << std::endl;
+  }
+
+  if (m_trace.GetNDropped() > 0)
+  {
+    std::cerr << PHWHERE << ": WARNING: trace buffers filled up, dropped " << m_trace.GetNDropped()
+              << " spans (increase traceCapacity to keep them)" << std::endl;
+  }
+  if (!m_trace.Write(m_config.traceFile))
+  {
+    std::cerr << PHWHERE << ": WARNING: couldn't write trace to '" << m_config.traceFile << "'" << std::endl;
+  }
+  else
+  {
+    std::cout << "BeamBackgroundFilterAndQA::WriteTrace() Wrote " << m_trace.GetNSpans() << " spans to " << m_config.traceFile << std::endl;
+  }
+
+  // detach filters before releasing buffers
+  for (BaseBeamBackgroundFilter* filter : m_filtersToApply)
+  {
+    filter->SetStageTrace(nullptr);
+  }
+  m_trace.Close();
+  return;
+
+}  // end 'WriteTrace()'
+
+
+
 // ----------------------------------------------------------------------------
 //! Apply relevant filters
 // ----------------------------------------------------------------------------
@@ -337,37 +820,363 @@ bool BeamBackgroundFilterAndQA::ApplyFilters(PHCompositeNode* topNode)
     std::cout << "BeamBackgroundFilterAndQA::ApplyFilters(PHCompositeNode*) Creating histograms" << std::endl;
   }
 
+  // determine if detailed qa should be filled for this event
+  const bool fillQA = m_config.doQA && IsQAEvent(topNode);
+  if (m_config.doQA)
+  {
+    m_qaSampling.Fill(bbfqd::Sampling::All);
+    if (fillQA)
+    {
+      m_qaSampling.Fill(bbfqd::Sampling::Sampled);
+    }
+  }
+
+  // determine if filters should be timed for this event
+  const bool doTiming = m_config.doQA &&
+                        (m_config.timingPrescale > 0) &&
+                        ((m_nEvtsSeen % m_config.timingPrescale) == 0);
+
+  // determine if hardware counters should be read for this event
+  const bool doPerf = m_perf.IsOpen() && ((m_nEvtsSeen % m_config.perfPrescale) == 0);
+
+  // if tracing, record the whole pass over the filters
+  StageTrace*       trace = m_trace.IsOpen() ? &m_trace : nullptr;
+  StageTrace::Scope traceAll(trace, "ApplyFilters", "module");
+
   // apply individual filters 
   bool hasBkgd = false;
-  for (const std::string& filterToApply : m_config.filtersToApply)
+  for (std::size_t iFilter = 0; iFilter < m_config.filtersToApply.size(); ++iFilter)
   {
-    const bool filterFoundBkgd = m_filters.at(filterToApply)->ApplyFilter(topNode);
-    if (filterFoundBkgd)
+    const std::string&        filterToApply = m_config.filtersToApply[iFilter];
+    BaseBeamBackgroundFilter* filter        = m_filtersToApply[iFilter];
+    filter->SetFillQA(fillQA);
+    filter->SetPerfCounters(doPerf ? &m_perf : nullptr);
+
+    const AllocationCounter::Counts allocStart = m_countAllocsThisEvt ? AllocationCounter::Read() : AllocationCounter::Counts();
+    const PerfCounters::Sample      perfStart  = doPerf ? m_perf.Begin() : PerfCounters::Sample();
+
+    std::chrono::steady_clock::time_point start;
+    if (doTiming)
     {
-      m_hists["nevts_" + filterToApply]->Fill(bbfqd::Status::HasBkgd);
-      m_consts->set_IntFlag("HasBeamBackground_" + filterToApply + "Filter", 1);
+      start = std::chrono::steady_clock::now();
     }
-    else
+
+    const uint64_t traceStart      = trace ? trace->Now() : 0;
+    const bool     filterFoundBkgd = filter->ApplyFilter(topNode);
+    if (trace)
+    {
+      trace->Record(filterToApply.data(), "filter", traceStart, trace->Now());
+    }
+    if (doTiming)
     {
-      m_hists["nevts_" + filterToApply]->Fill(bbfqd::Status::NoBkgd);
+      const double latency = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+      m_latencyPerFilter[iFilter].Fill(std::log10(std::max(latency, 1.)));
+      m_latencySum[iFilter] += latency;
+      ++m_nLatency[iFilter];
+    }
+    if (doPerf)
+    {
+      m_perf.End(perfStart, m_perfPerFilter[iFilter]);
+    }
+    if (m_countAllocsThisEvt)
+    {
+      m_allocsPerFilter[iFilter] += AllocationCounter::Read() - allocStart;
+    }
+
+    // n.b. flags are set every event, so that they're
+    // reset when there's no background
+    const uint64_t publishStart = trace ? trace->Now() : 0;
+    m_consts->set_IntFlag(m_flagNames[iFilter], filterFoundBkgd);
+    if (m_config.doQA)
+    {
+      m_nEvtsPerFilter[iFilter].Fill(filterFoundBkgd ? bbfqd::Status::HasBkgd : bbfqd::Status::NoBkgd);
+      m_nEvtsPerFilter[iFilter].Fill(bbfqd::Status::Evt);
+    }
+    if (m_snapshotWriter)
+    {
+      ++m_snapshotCounts[iFilter + 1][filterFoundBkgd ? bbfqd::Status::HasBkgd : bbfqd::Status::NoBkgd];
+      ++m_snapshotCounts[iFilter + 1][bbfqd::Status::Evt];
+    }
+    if (trace)
+    {
+      trace->Record("flag publish", filterToApply.data(), publishStart, trace->Now());
     }
-    m_hists["nevts_" + filterToApply]->Fill(bbfqd::Status::Evt);
     hasBkgd += filterFoundBkgd;
+
+    m_log.Log<bbfql::Trace>("  ", filterToApply, " filter found beam background? ", filterFoundBkgd);
   }
 
-  // fill overall histograms and return
-  m_hists["nevts_overall"]->Fill(bbfqd::Status::Evt);
-  if (hasBkgd)
+  // set overall flag, fill overall histograms, and return
+  StageTrace::Scope tracePublish(trace, "flag publish", "module");
+  m_consts->set_IntFlag("HasBeamBackground", hasBkgd);
+  if (m_config.doQA)
   {
-    m_hists["nevts_overall"]->Fill(bbfqd::Status::HasBkgd);
-    m_consts->set_IntFlag("HasBeamBackground", 1);
+    m_nEvtsOverall.Fill(hasBkgd ? bbfqd::Status::HasBkgd : bbfqd::Status::NoBkgd);
+    m_nEvtsOverall.Fill(bbfqd::Status::Evt);
   }
-  else
+  if (m_snapshotWriter)
   {
-    m_hists["nevts_overall"]->Fill(bbfqd::Status::NoBkgd);
+    ++m_snapshotCounts[0][hasBkgd ? bbfqd::Status::HasBkgd : bbfqd::Status::NoBkgd];
+    ++m_snapshotCounts[0][bbfqd::Status::Evt];
   }
   return hasBkgd;
 
 }  // end 'ApplyFilters(PHCompositeNode*)'
 
+
+
+// ----------------------------------------------------------------------------
+//! Check if detailed QA should be filled for this event
+// ----------------------------------------------------------------------------
+/*! Events are first prescaled by qaPrescale, and then sampled with
+ *  qaSampleFraction using a hash of the run and event numbers (or of
+ *  the module's event count if the EventHeader isn't available), so
+ *  the same events are selected on reprocessing.
+ */
+bool BeamBackgroundFilterAndQA::IsQAEvent(PHCompositeNode* topNode)
+{
+
+  // print debug message
+  if (m_config.debug && (Verbosity() > 1))
+  {
+    std::cout << "BeamBackgroundFilterAndQA::IsQAEvent(PHCompositeNode*) Checking if QA should be filled" << std::endl;
+  }
+
+  const uint64_t iEvt = m_nEvtsSeen;
+
+  // apply prescale
+  if ((m_config.qaPrescale > 1) && ((iEvt % m_config.qaPrescale) != 0))
+  {
+    return false;
+  }
+
+  // if not sampling, nothing else to check
+  if (m_config.qaSampleFraction >= 1.)
+  {
+    return true;
+  }
+
+  // otherwise, select based on hash of event
+  uint64_t run   = 0;
+  uint64_t event = iEvt;
+
+  EventHeader* header = findNode::getClass<EventHeader>(topNode, "EventHeader");
+  if (header)
+  {
+    run   = header->get_RunNumber();
+    event = header->get_EvtSequence();
+  }
+  return (bbfqd::HashEvent(run, event) < m_config.qaSampleFraction);
+
+}  // end 'IsQAEvent(PHCompositeNode*)'
+
+
+
+// ----------------------------------------------------------------------------
+//! Print mean and percentiles of filter latencies
+// ----------------------------------------------------------------------------
+/*! Means are exact, while percentiles are read off of the latency
+ *  histograms, and so are given as the upper edge of the bin they
+ *  fall in (i.e. to within ~25%).
+ */
+void BeamBackgroundFilterAndQA::PrintLatencySummary()
+{
+
+  // print debug message
+  if (m_config.debug && (Verbosity() > 0))
+  {
+    std::cout << "BeamBackgroundFilterAndQA::PrintLatencySummary() Summarizing filter latencies" << std::endl;
+  }
+
+  // find upper edge (in ns) of bin where cumulative fraction
+  // of a histogram reaches some value
+  auto getPercentile = [](TH1* hist, const double fraction)
+  {
+    const double total = hist->Integral(0, hist->GetNbinsX() + 1);
+    double       sum   = 0.;
+    for (int iBin = 0; iBin <= hist->GetNbinsX() + 1; ++iBin)
+    {
+      sum += hist->GetBinContent(iBin);
+      if (sum >= (fraction * total))
+      {
+        const int edgeBin = std::min(std::max(iBin, 1), hist->GetNbinsX());
+        return std::pow(10., hist->GetXaxis()->GetBinUpEdge(edgeBin));
+      }
+    }
+    return std::pow(10., hist->GetXaxis()->GetXmax());
+  };
+
+  std::cout << "BeamBackgroundFilterAndQA::PrintLatencySummary() Filter latencies (every "
+            << m_config.timingPrescale << " events):" << std::endl;
+  for (std::size_t iFilter = 0; iFilter < m_config.filtersToApply.size(); ++iFilter)
+  {
+    if (m_nLatency[iFilter] == 0) continue;
+
+    TH1* hist = m_latencyPerFilter[iFilter].GetHist();
+    std::cout << "    " << m_config.filtersToApply[iFilter] << ": "
+              << "n = " << m_nLatency[iFilter] << ", "
+              << "mean = " << (m_latencySum[iFilter] / m_nLatency[iFilter]) / 1000. << " us, "
+              << "p50 < " << getPercentile(hist, 0.50) / 1000. << " us, "
+              << "p90 < " << getPercentile(hist, 0.90) / 1000. << " us, "
+              << "p99 < " << getPercentile(hist, 0.99) / 1000. << " us"
+              << std::endl;
+  }
+  return;
+
+}  // end 'PrintLatencySummary()'
+
+
+
+// ----------------------------------------------------------------------------
+//! Print averages of hardware counts
+// ----------------------------------------------------------------------------
+void BeamBackgroundFilterAndQA::PrintPerfSummary()
+{
+
+  // print debug message
+  if (m_config.debug && (Verbosity() > 0))
+  {
+    std::cout << "BeamBackgroundFilterAndQA::PrintPerfSummary() Summarizing hardware counts" << std::endl;
+  }
+
+  std::cout << "BeamBackgroundFilterAndQA::PrintPerfSummary() Hardware counts per call (every "
+            << m_config.perfPrescale << " events):" << std::endl;
+  for (std::size_t iFilter = 0; iFilter < m_config.filtersToApply.size(); ++iFilter)
+  {
+    const std::string& filterToApply = m_config.filtersToApply[iFilter];
+    m_perf.Print(filterToApply, m_perfPerFilter[iFilter]);
+
+    // add map builds, if filter measured any
+    const PerfCounters::Counts& buildCounts = m_filters.at(filterToApply)->GetBuildCounts();
+    if (buildCounts.nCalls > 0)
+    {
+      m_perf.Print(filterToApply + " map build", buildCounts);
+    }
+  }
+  return;
+
+}  // end 'PrintPerfSummary()'
+
+
+
+// ----------------------------------------------------------------------------
+//! Print averages of allocations per event
+// ----------------------------------------------------------------------------
+void BeamBackgroundFilterAndQA::PrintAllocSummary()
+{
+
+  // print debug message
+  if (m_config.debug && (Verbosity() > 0))
+  {
+    std::cout << "BeamBackgroundFilterAndQA::PrintAllocSummary() Summarizing allocations" << std::endl;
+  }
+
+  const double nEvts = std::max<uint64_t>(m_nAllocEvts, 1);
+  auto print = [nEvts](const std::string& label, const AllocationCounter::Counts& counts)
+  {
+    std::cout << "    " << label << ": "
+              << counts.nAllocs / nEvts << " allocations, "
+              << counts.nBytes / nEvts << " bytes"
+              << std::endl;
+  };
+
+  std::cout << "BeamBackgroundFilterAndQA::PrintAllocSummary() Heap allocations per event (over "
+            << m_nAllocEvts << " events, after " << m_config.nAllocWarmUp << " warm-up events):" << std::endl;
+  print("process_event (total)", m_allocsOverall);
+  for (std::size_t iFilter = 0; iFilter < m_config.filtersToApply.size(); ++iFilter)
+  {
+    print(m_config.filtersToApply[iFilter], m_allocsPerFilter[iFilter]);
+  }
+  return;
+
+}  // end 'PrintAllocSummary()'
+
+
+
+// ----------------------------------------------------------------------------
+//! Stop counting allocations for this event, and check them
+// ----------------------------------------------------------------------------
+/*! Returns false if asserting no allocations and there were some (in
+ *  which case, where they happened is printed).
+ */
+bool BeamBackgroundFilterAndQA::FinishAllocCount(const AllocationCounter::Counts& start)
+{
+
+  const AllocationCounter::Counts allocs = AllocationCounter::Read() - start;
+  AllocationCounter::Stop();
+
+  m_allocsOverall += allocs;
+  ++m_nAllocEvts;
+
+  // n.b. any earlier allocation would have already been
+  // caught, so totals so far are from this event
+  const bool isOk = !m_config.assertNoAllocs || (allocs.nAllocs == 0);
+  if (!isOk)
+  {
+    std::cerr << PHWHERE << ": PANIC! " << allocs.nAllocs << " allocation(s) (" << allocs.nBytes
+              << " bytes) in process_event of event " << m_nEvtsSeen - 1 << "!" << std::endl;
+    for (std::size_t iFilter = 0; iFilter < m_config.filtersToApply.size(); ++iFilter)
+    {
+      std::cerr << "    " << m_config.filtersToApply[iFilter] << ": " << m_allocsPerFilter[iFilter].nAllocs
+                << " allocation(s), " << m_allocsPerFilter[iFilter].nBytes << " bytes" << std::endl;
+    }
+    assert(isOk);
+  }
+  return isOk;
+
+}  // end 'FinishAllocCount(AllocationCounter::Counts&)'
+
+
+
+// ----------------------------------------------------------------------------
+//! Take an online snapshot, if it's time to
+// ----------------------------------------------------------------------------
+/*! The clock is only checked when snapshotSeconds is set. Publishing
+ *  never blocks: if the writer is still busy with the last snapshot,
+ *  this one is dropped and another is tried on the next event.
+ */
+void BeamBackgroundFilterAndQA::UpdateSnapshot()
+{
+
+  // check if enough events have passed
+  bool isTime = (m_config.snapshotEvery > 0) && ((m_nEvtsSeen - m_lastSnapshotEvt) >= m_config.snapshotEvery);
+
+  // or if enough time has passed
+  if (!isTime && (m_config.snapshotSeconds > 0.))
+  {
+    const auto sinceLast = std::chrono::steady_clock::now() - m_lastSnapshotTime;
+    isTime = (std::chrono::duration<double>(sinceLast).count() >= m_config.snapshotSeconds);
+  }
+  if (!isTime) return;
+
+  // if so, hand snapshot over to writer
+  FillSnapshot();
+  if (m_snapshotWriter->Publish(m_snapshot))
+  {
+    m_lastSnapshotEvt  = m_nEvtsSeen;
+    m_lastSnapshotTime = std::chrono::steady_clock::now();
+  }
+  return;
+
+}  // end 'UpdateSnapshot()'
+
+
+
+// ----------------------------------------------------------------------------
+//! Copy current counts into snapshot
+// ----------------------------------------------------------------------------
+/*! n.b. the snapshot buffers are all sized in InitSnapshots, so these
+ *  copies reuse their storage rather than allocating.
+ */
+void BeamBackgroundFilterAndQA::FillSnapshot()
+{
+
+  m_snapshot.nEvents = m_nEvtsSeen;
+  m_snapshot.elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - m_startTime).count();
+  m_snapshot.names   = m_snapshotNames;
+  m_snapshot.counts  = m_snapshotCounts;
+  return;
+
+}  // end 'FillSnapshot()'
+
 // end ========================================================================
@@ -13,6 +13,9 @@
 #define BEAMBACKGROUNDFILTERANDQA_H
 
 // c++ utilities
+#include <array>
+#include <chrono>
+#include <cstdint>
 #include <map>
 #include <memory>
 #include <string>
@@ -22,9 +25,14 @@
 #include <fun4all/SubsysReco.h>
 
 // module components
+#include "AllocationCounter.h"
 #include "BaseBeamBackgroundFilter.h"
-#include "NullFilter.h"
-#include "StreakSidebandFilter.h"
+#include "BeamBackgroundFilterAndQADefs.h"
+#include "BeamBackgroundFilterAndQALog.h"
+#include "HistAccumulator.h"
+#include "PerfCounters.h"
+#include "QASnapshotWriter.h"
+#include "StageTrace.h"
 
 // forward declarations
 class Fun4AllHistoManager;
@@ -53,23 +61,92 @@ class BeamBackgroundFilterAndQA : public SubsysReco {
     {
 
       // turn modes on/off
-      bool debug      = true;
+      bool debug      = false;
       bool doQA       = true;
       bool doEvtAbort = false;
 
       ///! module name
       std::string moduleName = "BeamBackgroundFilterAndQA";
 
+      ///! logging: messages up to printLevel are printed right away,
+      ///! while messages up to traceLevel are kept in a buffer of the
+      ///! last nLogTraces events, which is dumped when the run is
+      ///! aborted and (optionally) at End. Filters log into the same
+      ///! buffer. n.b. Debug and Trace are only compiled in when
+      ///! building w/ -DBBFQA_MAX_LOG_LEVEL=4 (or 5)
+      BeamBackgroundFilterAndQALog::Level printLevel = BeamBackgroundFilterAndQALog::Warn;
+      BeamBackgroundFilterAndQALog::Level traceLevel = BeamBackgroundFilterAndQALog::Info;
+      std::size_t nLogTraces      = 16;
+      bool        dumpTracesAtEnd = false;
+
       ///! histogram tags
       std::string histTag = "";
 
+      ///! qa sampling: detailed histograms are only filled for every
+      ///! Nth event (qaPrescale) and/or a deterministic, hash-selected
+      ///! fraction of events (qaSampleFraction); event counts are
+      ///! always filled
+      uint32_t qaPrescale       = 1;
+      double   qaSampleFraction = 1.;
+
+      ///! timing: if timingPrescale > 0 (and doing QA), each filter is
+      ///! timed every timingPrescale-th event, its latency histogrammed
+      ///! (in log10 of ns), and a summary is printed at End
+      uint32_t timingPrescale = 0;
+
+      ///! hardware counters: if perfPrescale > 0, cycles, instructions,
+      ///! cache misses, and branch misses are counted around each filter
+      ///! (and its map build) every perfPrescale-th event, and averages
+      ///! are printed at End (does nothing if counters are unavailable)
+      uint32_t perfPrescale = 0;
+
+      ///! allocations: if countAllocs is set, heap allocations (and
+      ///! bytes) made during process_event are counted for each filter
+      ///! and the module overall, and averages per event are printed at
+      ///! End; if assertNoAllocs is set, any allocation is fatal. Both
+      ///! skip the first nAllocWarmUp events, and need the allocation
+      ///! hooks library to be preloaded (see AllocationHooks.cc)
+      bool     countAllocs    = false;
+      bool     assertNoAllocs = false;
+      uint64_t nAllocWarmUp   = 100;
+
+      ///! tracing: if traceFile is set, begin/end times of each filter
+      ///! and its stages (e.g. map build, candidate scan, qa fill) and
+      ///! of flag publishing are recorded into buffers of traceCapacity
+      ///! spans per worker slot (spans past that are dropped), and are
+      ///! written at End as a Chrome trace (open in chrome://tracing or
+      ///! ui.perfetto.dev)
+      std::string traceFile     = "";
+      std::size_t traceCapacity = 1 << 17;
+
+      ///! no. of threads which may fill histograms at once
+      std::size_t nWorkerSlots = 1;
+
+      ///! qa memory: budget per filter (in bytes, 0 = no limit), what to
+      ///! do with histograms which exceed it, and whether to print the
+      ///! footprint of each filter at Init
+      std::size_t                           qaBudget          = 0;
+      BeamBackgroundFilterAndQADefs::Budget qaBudgetPolicy    = BeamBackgroundFilterAndQADefs::Budget::Refuse;
+      bool                                  reportQAFootprint = true;
+
+      ///! online snapshots: if snapshotFile is set, event counts are
+      ///! written there every snapshotEvery events and/or every
+      ///! snapshotSeconds seconds (0 = off) while the job runs
+      std::string snapshotFile    = "";
+      uint64_t    snapshotEvery   = 1000;
+      double      snapshotSeconds = 0.;
+
+      ///! if set, QA histograms are also written to this file at End in
+      ///! the binary sidecar format (see QASidecar.h), which can be
+      ///! merged across many jobs quickly with mergeqasidecars
+      std::string qaSidecarFile = "";
+
       ///! which filters to apply
       std::vector<std::string> filtersToApply = {"Null", "StreakSideband"};
 
-      ///! filter configurations
-      NullFilter::Config null;
-      StreakSidebandFilter::Config sideband;
-      //... add other configurations here ...//
+      ///! filter configurations, keyed by filter name, e.g.
+      ///!   {{"StreakSideband", {{"minStreakTwrEne", "0.6"}}}}
+      std::map<std::string, BeamBackgroundFilterAndQADefs::Parameters> filterParams;
 
     };
 
@@ -89,15 +166,32 @@ class BeamBackgroundFilterAndQA : public SubsysReco {
     int process_event(PHCompositeNode* topNode) override;
     int End(PHCompositeNode* /*topNode*/) override;
 
+    // other public methods
+    void MergeHistograms();
+
   private:
 
     // private methods
     void InitFilters();
     void InitFlags();
     void InitHistManager();
+    void InitSnapshots();
+    void InitPerfCounters();
+    bool InitAllocCounter();
+    void InitTrace();
     void BuildHistograms();
+    void ReportQAFootprint();
     void RegisterHistograms();
+    void WriteSidecar();
+    void WriteTrace();
     bool ApplyFilters(PHCompositeNode* topNode);
+    bool IsQAEvent(PHCompositeNode* topNode);
+    void PrintLatencySummary();
+    void PrintPerfSummary();
+    void PrintAllocSummary();
+    bool FinishAllocCount(const AllocationCounter::Counts& start);
+    void UpdateSnapshot();
+    void FillSnapshot();
 
     ///! histogram manager
     Fun4AllHistoManager* m_manager;
@@ -105,15 +199,66 @@ class BeamBackgroundFilterAndQA : public SubsysReco {
     ///! reco consts (for flags)
     recoConsts* m_consts;
 
+    ///! logger
+    BeamBackgroundFilterAndQALog::Logger m_log;
+
     ///! module-wide histograms
     std::map<std::string, TH1*> m_hists;
 
+    ///! accumulators for module-wide histograms
+    ///!   - n.b. per-filter ones follow order of filtersToApply
+    HistAccumulator<uint64_t>              m_nEvtsOverall;
+    HistAccumulator<uint64_t>              m_qaSampling;
+    std::vector<HistAccumulator<uint64_t>> m_nEvtsPerFilter;
+
+    ///! latency accumulators, and sum (in ns) + no.
+    ///! of timed calls for each filter
+    std::vector<HistAccumulator<uint64_t>> m_latencyPerFilter;
+    std::vector<double>                    m_latencySum;
+    std::vector<uint64_t>                  m_nLatency;
+
+    ///! hardware counters, and counts for each filter
+    PerfCounters                      m_perf;
+    std::vector<PerfCounters::Counts> m_perfPerFilter;
+
+    ///! timeline of filter stages
+    StageTrace m_trace;
+
+    ///! allocation counting: whether it's on (at all, and for the
+    ///! current event), allocations in each filter and in
+    ///! process_event overall, and no. of events counted
+    bool                                   m_countAllocs;
+    bool                                   m_countAllocsThisEvt;
+    std::vector<AllocationCounter::Counts> m_allocsPerFilter;
+    AllocationCounter::Counts              m_allocsOverall;
+    uint64_t                               m_nAllocEvts;
+
+    ///! no. of events seen so far
+    uint64_t m_nEvtsSeen;
+
+    ///! online snapshots: writer, snapshot being filled, names and
+    ///! (all, no bkgd., has bkgd.) counts of overall + each filter,
+    ///! and when the last snapshot was taken
+    std::unique_ptr<QASnapshotWriter>     m_snapshotWriter;
+    QASnapshotWriter::Snapshot            m_snapshot;
+    std::vector<std::string>              m_snapshotNames;
+    std::vector<std::array<uint64_t, 3>>  m_snapshotCounts;
+    std::chrono::steady_clock::time_point m_startTime;
+    std::chrono::steady_clock::time_point m_lastSnapshotTime;
+    uint64_t                              m_lastSnapshotEvt;
+
     ///! module configuration
     Config m_config;
 
     ///! filters
     std::map<std::string, std::unique_ptr<BaseBeamBackgroundFilter>> m_filters;
 
+    ///! filters and names of their flags, in order of
+    ///! filtersToApply (so the event loop needn't look
+    ///! anything up or build any strings)
+    std::vector<BaseBeamBackgroundFilter*> m_filtersToApply;
+    std::vector<std::string>               m_flagNames;
+
 };  // end BeamBackgroundFilterAndQA
 
 #endif
@@ -15,6 +15,13 @@
 // c++ utilities
 #include <algorithm>
 #include <array>
+#include <cassert>
+#include <cstdint>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
 
 // calo base
 #include <calobase/TowerInfo.h>
@@ -39,6 +46,47 @@ namespace BeamBackgroundFilterAndQADefs {
 
 
 
+  // ==========================================================================
+  //! QA sampling status codes
+  // ==========================================================================
+  /*! This enumerates the bins of the QA sampling histogram:
+   *    All     = all events seen by the module
+   *    Sampled = events for which detailed QA was filled
+   */
+  enum Sampling {All, Sampled};
+
+
+
+  // ==========================================================================
+  //! QA memory budget policies
+  // ==========================================================================
+  /*! This enumerates what to do with a histogram which would exceed a
+   *  filter's QA memory budget:
+   *    Refuse     = don't create it (fills are dropped)
+   *    Downsample = create it with fewer bins
+   */
+  enum class Budget {Refuse, Downsample};
+
+
+
+  // ==========================================================================
+  //! Hash a (run, event) pair onto [0, 1)
+  // ==========================================================================
+  /*! Deterministic (splitmix64) hash used to select a reproducible
+   *  subset of events, e.g. for sampling QA.
+   */
+  inline double HashEvent(const uint64_t run, const uint64_t event)
+  {
+    uint64_t hash = (run << 32) ^ event;
+    hash += 0x9e3779b97f4a7c15ULL;
+    hash  = (hash ^ (hash >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    hash  = (hash ^ (hash >> 27)) * 0x94d049bb133111ebULL;
+    hash ^= (hash >> 31);
+    return static_cast<double>(hash >> 11) * 0x1.0p-53;
+  }
+
+
+
   // ==========================================================================
   // Helper struct to scrape info from TowerInfo
   // ==========================================================================
@@ -76,6 +124,54 @@ namespace BeamBackgroundFilterAndQADefs {
 
 
 
+  // ==========================================================================
+  //! Non-owning view of an (eta, phi) map of towers
+  // ==========================================================================
+  /*! This is a lightweight struct which points to a contiguous, row-major
+   *  (eta, phi) block of Tower structs, e.g. the storage of a TowerMap (see
+   *  below) or a buffer of pre-recorded events. Filters can run directly on
+   *  these without going through the node tree.
+   */
+  struct TowerView
+  {
+
+    // members
+    const Tower* towers = nullptr;
+    std::size_t  nEta   = 0;
+    std::size_t  nPhi   = 0;
+
+    //! access tower at (eta, phi)
+    const Tower& At(const std::size_t iEta, const std::size_t iPhi) const
+    {
+      return towers[(iEta * nPhi) + iPhi];
+    }
+
+    //! check if view points to anything
+    bool IsValid() const
+    {
+      return (towers != nullptr);
+    }
+
+  };  // end TowerView
+
+
+
+  // ==========================================================================
+  //! Snapshot of the calorimeter towers in a single event
+  // ==========================================================================
+  /*! Collects views of the (eta, phi) tower maps of each calorimeter
+   *  for one event. Filters only need to look at the calorimeters they
+   *  use, so views which aren't needed can be left empty.
+   */
+  struct TowerSnapshot
+  {
+    TowerView emcal;
+    TowerView ihcal;
+    TowerView ohcal;
+  };
+
+
+
   // ==========================================================================
   //! Helper type for building (eta, phi) maps of towers
   // ==========================================================================
@@ -86,9 +182,20 @@ namespace BeamBackgroundFilterAndQADefs {
   template <std::size_t H, std::size_t F> struct TowerMap
   {
 
+    // dimensions
+    static constexpr std::size_t nEta = H;
+    static constexpr std::size_t nPhi = F;
+
     // members
     std::array<std::array<Tower, F>, H> towers;
 
+    // views treat the rows as one contiguous block, which
+    // needs std::array to add no padding
+    static_assert(
+      sizeof(std::array<std::array<Tower, F>, H>) == (H * F * sizeof(Tower)),
+      "TowerMap: rows of towers must be contiguous"
+    );
+
     //! build array
     void Build(TowerInfoContainer* container)
     {
@@ -105,9 +212,9 @@ namespace BeamBackgroundFilterAndQADefs {
     //! reset 
     void Reset()
     {
-      for (auto row : towers)
+      for (auto& row : towers)
       {
-        for (auto tower : row)
+        for (auto& tower : row)
         {
           tower.Reset();
         }
@@ -115,6 +222,19 @@ namespace BeamBackgroundFilterAndQADefs {
       return;
     }
 
+    //! get all towers as one row-major block
+    //!   - n.b. the pointer is taken from the whole map (not
+    //!     its first row), so indexing past the first row
+    //!     doesn't step outside of the object it points into
+    const Tower* Data() const {return reinterpret_cast<const Tower*>(&towers);}
+    Tower*       Data()       {return reinterpret_cast<Tower*>(&towers);}
+
+    //! get a view of the map
+    TowerView View() const
+    {
+      return TowerView {Data(), H, F};
+    }
+
   };  // end TowerArray
 
   // --------------------------------------------------------------------------
@@ -126,6 +246,123 @@ namespace BeamBackgroundFilterAndQADefs {
 
 
 
+  // ==========================================================================
+  //! Generic key/value block for configuring filters
+  // ==========================================================================
+  /*! Filters created through the filter factory (see
+   *  BaseBeamBackgroundFilter) are configured from one of these, e.g.
+   *
+   *    {{"minStreakTwrEne", "0.6"}, {"minNumTwrsInStreak", "5"}}
+   */
+  typedef std::map<std::string, std::string> Parameters;
+
+
+
+  // ==========================================================================
+  //! Read a value from a parameter block
+  // ==========================================================================
+  /*! Sets value to the parameter stored under key, if it exists. Otherwise
+   *  value is left untouched, so it should hold the default beforehand.
+   *  A parameter which doesn't parse as a whole (e.g. "0,6" for a double)
+   *  is fatal, rather than quietly leaving a zeroed or default cut.
+   */
+  template <typename T> void ReadParameter(
+    const Parameters& params,
+    const std::string& key,
+    T& value
+  ) {
+
+    auto param = params.find(key);
+    if (param == params.end()) return;
+
+    T parsed {};
+    std::istringstream stream(param->second);
+    stream >> parsed;
+    const bool isParsed = !stream.fail() && (stream >> std::ws).eof();
+    if (!isParsed)
+    {
+      std::cerr << "BeamBackgroundFilterAndQADefs::ReadParameter() PANIC! Couldn't parse value '" << param->second << "' of parameter '" << key << "'!" << std::endl;
+      assert(isParsed);
+      return;
+    }
+    value = parsed;
+    return;
+
+  }  // end 'ReadParameter(Parameters&, std::string&, T&)'
+
+  // --------------------------------------------------------------------------
+  //! Read a value from a parameter block (strings)
+  // --------------------------------------------------------------------------
+  template <> inline void ReadParameter<std::string>(
+    const Parameters& params,
+    const std::string& key,
+    std::string& value
+  ) {
+
+    auto param = params.find(key);
+    if (param == params.end()) return;
+
+    value = param->second;
+    return;
+
+  }  // end 'ReadParameter<std::string>(Parameters&, std::string&, std::string&)'
+
+  // --------------------------------------------------------------------------
+  //! Read a value from a parameter block (booleans)
+  // --------------------------------------------------------------------------
+  /*! Accepts "true"/"false" as well as "1"/"0"; anything else is fatal.
+   */
+  template <> inline void ReadParameter<bool>(
+    const Parameters& params,
+    const std::string& key,
+    bool& value
+  ) {
+
+    auto param = params.find(key);
+    if (param == params.end()) return;
+
+    const bool isTrue  = (param->second == "true") || (param->second == "1");
+    const bool isFalse = (param->second == "false") || (param->second == "0");
+    if (!isTrue && !isFalse)
+    {
+      std::cerr << "BeamBackgroundFilterAndQADefs::ReadParameter() PANIC! Couldn't parse value '" << param->second << "' of parameter '" << key << "' as true/false!" << std::endl;
+      assert(isTrue || isFalse);
+      return;
+    }
+    value = isTrue;
+    return;
+
+  }  // end 'ReadParameter<bool>(Parameters&, std::string&, bool&)'
+
+  // --------------------------------------------------------------------------
+  //! Check that a parameter block only holds known keys
+  // --------------------------------------------------------------------------
+  /*! Meant to be called from a filter's ReadConfig w/ all of the keys it
+   *  reads, so that a misspelled key is fatal rather than quietly leaving
+   *  the default in place. Returns false if any key was unknown.
+   */
+  inline bool CheckParameters(
+    const Parameters& params,
+    const std::vector<std::string>& known,
+    const std::string& owner
+  ) {
+
+    bool areKnown = true;
+    for (const auto& param : params)
+    {
+      if (std::find(known.begin(), known.end(), param.first) == known.end())
+      {
+        std::cerr << "BeamBackgroundFilterAndQADefs::CheckParameters() PANIC! Unknown parameter '" << param.first << "' for " << owner << "!" << std::endl;
+        areKnown = false;
+      }
+    }
+    assert(areKnown);
+    return areKnown;
+
+  }  // end 'CheckParameters(Parameters&, std::vector<std::string>&, std::string&)'
+
+
+
   // ==========================================================================
   //! Make QA-compliant histogram names
   // ==========================================================================
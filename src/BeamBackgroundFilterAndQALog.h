@@ -0,0 +1,236 @@
+/// ===========================================================================
+/*! \file    BeamBackgroundFilterAndQALog.h
+ *  \authors Derek Anderson
+ *  \date    10.16.2026
+ *
+ *  A small logging layer for the BeamBackgroundFilterAndQA
+ *  module and its filters: levels are gated at compile
+ *  time, and per-event traces are kept in a ring buffer
+ *  rather than printed.
+ */
+/// ===========================================================================
+
+#ifndef BEAMBACKGROUNDFILTERANDQALOG_H
+#define BEAMBACKGROUNDFILTERANDQALOG_H
+
+// c++ utilities
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+// ----------------------------------------------------------------------------
+//! Most verbose level compiled in
+// ----------------------------------------------------------------------------
+/*! Anything more verbose than this compiles away entirely. Defaults
+ *  to Info, so per-event (Debug) and per-filter (Trace) messages cost
+ *  nothing in production. Can be overridden at build time, e.g.
+ *  -DBBFQA_MAX_LOG_LEVEL=5 to enable everything.
+ */
+#ifndef BBFQA_MAX_LOG_LEVEL
+#define BBFQA_MAX_LOG_LEVEL 3
+#endif
+
+
+
+// ============================================================================
+//! Beam background filter and QA logging
+// ============================================================================
+namespace BeamBackgroundFilterAndQALog {
+
+  // ==========================================================================
+  //! Log levels
+  // ==========================================================================
+  /*! In order of increasing verbosity:
+   *    Off   = nothing
+   *    Error = something went wrong
+   *    Warn  = something looks off
+   *    Info  = general progress
+   *    Debug = per-event information
+   *    Trace = per-tower/per-filter details
+   */
+  enum Level {Off, Error, Warn, Info, Debug, Trace};
+
+  // --------------------------------------------------------------------------
+  //! Check if a level is compiled in
+  // --------------------------------------------------------------------------
+  template <Level L> constexpr bool IsCompiled()
+  {
+    return (static_cast<int>(L) <= BBFQA_MAX_LOG_LEVEL);
+  }
+
+
+
+  // ==========================================================================
+  //! Stream buffer which appends to a string
+  // ==========================================================================
+  /*! Lets messages be formatted straight into a (reused) trace string,
+   *  rather than into a temporary one which is then copied.
+   */
+  class StringSink : public std::streambuf
+  {
+
+    public:
+
+      ///! set string to append to
+      void SetTarget(std::string* target) {m_target = target;}
+
+    protected:
+
+      int_type overflow(int_type ch) override
+      {
+        if (!traits_type::eq_int_type(ch, traits_type::eof()))
+        {
+          m_target->push_back(traits_type::to_char_type(ch));
+        }
+        return traits_type::not_eof(ch);
+      }
+
+      std::streamsize xsputn(const char* str, std::streamsize count) override
+      {
+        m_target->append(str, count);
+        return count;
+      }
+
+    private:
+
+      ///! string being appended to
+      std::string* m_target = nullptr;
+
+  };  // end StringSink
+
+
+
+  // ==========================================================================
+  //! Logger with a ring buffer of event traces
+  // ==========================================================================
+  /*! Messages at or below the print level go to stdout/stderr right away,
+   *  and messages at or below the trace level are recorded in the trace
+   *  of the current event. Only the last N event traces are kept, and
+   *  they're only printed when Dump() is called (e.g. when a run is
+   *  aborted or at the end of a job). The trace strings are reused from
+   *  event to event, so once warmed up recording doesn't allocate.
+   */
+  class Logger
+  {
+
+    public:
+
+      // ----------------------------------------------------------------------
+      //! ctor accepting levels and buffer size
+      // ----------------------------------------------------------------------
+      Logger(
+        const Level printLevel = Level::Warn,
+        const Level traceLevel = Level::Info,
+        const std::size_t nTraces = 16
+      ) : m_printLevel(printLevel)
+        , m_traceLevel(traceLevel)
+        , m_traces(std::max<std::size_t>(nTraces, 1))
+        , m_events(std::max<std::size_t>(nTraces, 1), 0)
+      {}
+
+      // ----------------------------------------------------------------------
+      //! Start trace for a new event
+      // ----------------------------------------------------------------------
+      /*! Overwrites the oldest trace in the buffer.
+       */
+      void BeginEvent(const uint64_t event)
+      {
+        m_current = (m_nEvents++) % m_traces.size();
+        m_traces[m_current].clear();
+        m_events[m_current] = event;
+        return;
+      }
+
+      // ----------------------------------------------------------------------
+      //! Log a message
+      // ----------------------------------------------------------------------
+      /*! Arguments are streamed one after another, e.g.
+       *
+       *    m_log.Log<bbfql::Debug>("Found ", nStreak, " streaks");
+       *
+       *  If L isn't compiled in, this is a no-op.
+       */
+      template <Level L, typename... Args> void Log(const Args&... args)
+      {
+        if constexpr (IsCompiled<L>())
+        {
+          const bool doPrint = (L <= m_printLevel);
+          const bool doTrace = (L <= m_traceLevel) && (m_nEvents > 0);
+          if (!doPrint && !doTrace) return;
+
+          // format into the current trace if tracing, and into
+          // the scratch string if only printing
+          std::string&      message = doTrace ? m_traces[m_current] : m_scratch;
+          const std::size_t start   = doTrace ? message.size() : 0;
+          if (!doTrace) m_scratch.clear();
+
+          m_sink.SetTarget(&message);
+          std::ostream stream(&m_sink);
+          (stream << ... << args);
+
+          if (doPrint)
+          {
+            std::ostream& out = (L <= Level::Warn) ? std::cerr : std::cout;
+            out.write(message.data() + start, message.size() - start);
+            out << std::endl;
+          }
+          if (doTrace)
+          {
+            message.push_back('\n');
+          }
+        }
+        return;
+      }
+
+      // ----------------------------------------------------------------------
+      //! Dump buffered traces
+      // ----------------------------------------------------------------------
+      /*! Prints the buffered traces from oldest to newest.
+       */
+      void Dump(std::ostream& out = std::cout) const
+      {
+        const std::size_t nStored = std::min<uint64_t>(m_nEvents, m_traces.size());
+        const std::size_t iFirst  = (m_nEvents > m_traces.size()) ? (m_current + 1) % m_traces.size() : 0;
+
+        out << "---- Last " << nStored << " event trace(s) ----" << std::endl;
+        for (std::size_t iStored = 0; iStored < nStored; ++iStored)
+        {
+          const std::size_t iTrace = (iFirst + iStored) % m_traces.size();
+          out << "[event " << m_events[iTrace] << "]\n" << m_traces[iTrace];
+        }
+        out << "---- End of traces ----" << std::endl;
+        return;
+      }
+
+      ///! set levels
+      void SetPrintLevel(const Level level) {m_printLevel = level;}
+      void SetTraceLevel(const Level level) {m_traceLevel = level;}
+
+    private:
+
+      ///! levels
+      Level m_printLevel;
+      Level m_traceLevel;
+
+      ///! buffered traces and their event numbers
+      std::vector<std::string> m_traces;
+      std::vector<uint64_t>    m_events;
+
+      ///! current trace, no. of events traced
+      std::size_t m_current = 0;
+      uint64_t    m_nEvents = 0;
+
+      ///! for formatting messages
+      StringSink  m_sink;
+      std::string m_scratch;
+
+  };  // end Logger
+
+}  // end BeamBackgroundFilterAndQALog
+
+#endif
+
+// end ========================================================================
@@ -0,0 +1,281 @@
+/// ===========================================================================
+/*! \file    BenchBeamBackgroundFilters.cc
+ *  \authors Derek Anderson
+ *  \date    10.16.2026
+ *
+ *  Micro-benchmarks of the beam background filters and
+ *  tower maps on in-memory tower grids, i.e. without
+ *  Fun4All, DSTs, or the CDB.
+ *
+ *  Usage (or just 'make bench'):
+ *    benchbeambackgroundfilters [-t <min. seconds per kernel>]
+ *                               [-r <repeats per kernel>]
+ *                               [--json <output file>]
+ *
+ *  With --json, the events/s of each kernel on each grid
+ *  are also written out, which is what 'make bench-check'
+ *  compares against the checked-in baseline.
+ */
+/// ===========================================================================
+
+// c++ utilities
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <memory>
+#include <string>
+#include <tuple>
+#include <vector>
+
+// calo base
+#include <calobase/TowerInfoContainerv1.h>
+
+// module components
+#include "BeamBackgroundFilterAndQADefs.h"
+#include "NullFilter.h"
+#include "StreakSidebandFilter.h"
+#include "SyntheticEventGenerator.h"
+
+// alias for convenience
+namespace bbfqd = BeamBackgroundFilterAndQADefs;
+
+
+
+namespace
+{
+
+  // ==========================================================================
+  //! Grids to benchmark on
+  // ==========================================================================
+  /*! Roughly: empty has nothing in it, min-bias has ~5% of towers occupied
+   *  (w/ exponential energies of ~0.2 GeV), a single streak adds a 1 GeV
+   *  streak along all of eta at one phi on top of that, and dense showers
+   *  have ~60% of towers occupied at ~1 GeV.
+   */
+  std::vector<std::pair<std::string, OHCalEventGenerator::Config>> MakeGrids()
+  {
+    OHCalEventGenerator::Config empty;
+    empty.noiseSigma        = 0.;
+    empty.badStatusFraction = 0.;
+    empty.pileUpOccupancy   = 0.;
+
+    OHCalEventGenerator::Config minBias;
+
+    OHCalEventGenerator::Config singleStreak;
+    singleStreak.streakProbability = 1.;
+    singleStreak.minStreakLength   = bbfqd::OHCalMap::nEta;
+
+    OHCalEventGenerator::Config dense;
+    dense.pileUpOccupancy = 0.60;
+    dense.pileUpMeanEne   = 1.0;
+
+    return {
+      {"empty",        empty},
+      {"minbias",      minBias},
+      {"singlestreak", singleStreak},
+      {"dense",        dense}
+    };
+  }
+
+  ///! no. of distinct events per grid to cycle through
+  constexpr std::size_t NPool = 64;
+
+
+
+  // --------------------------------------------------------------------------
+  //! Time a kernel
+  // --------------------------------------------------------------------------
+  /*! Runs the kernel (which processes the i-th event of the pool) over
+   *  whole passes of the pool until at least minTime seconds have gone
+   *  by, and returns the time per event in ns.
+   */
+  double TimeKernel(const std::function<uint64_t(std::size_t)>& kernel, const double minTime, uint64_t& sink)
+  {
+    // warm up caches
+    for (std::size_t iEvt = 0; iEvt < NPool; ++iEvt)
+    {
+      sink += kernel(iEvt);
+    }
+
+    std::size_t nEvts   = 0;
+    double      elapsed = 0.;
+    const auto  start   = std::chrono::steady_clock::now();
+    while (elapsed < minTime)
+    {
+      for (std::size_t iEvt = 0; iEvt < NPool; ++iEvt)
+      {
+        sink += kernel(iEvt);
+      }
+      nEvts  += NPool;
+      elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+    return (elapsed * 1e9) / nEvts;
+  }
+
+}  // end anonymous namespace
+
+
+
+// ============================================================================
+//! Run benchmarks
+// ============================================================================
+int main(int argc, char* argv[])
+{
+
+  // parse arguments
+  double      minTime  = 0.5;
+  int         nRepeats = 1;
+  std::string jsonFile = "";
+  for (int iArg = 1; iArg < argc; ++iArg)
+  {
+    const std::string arg = argv[iArg];
+    if ((arg == "-t") && (iArg + 1 < argc))
+    {
+      minTime = std::atof(argv[++iArg]);
+    }
+    else if ((arg == "-r") && (iArg + 1 < argc))
+    {
+      nRepeats = std::max(std::atoi(argv[++iArg]), 1);
+    }
+    else if ((arg == "--json") && (iArg + 1 < argc))
+    {
+      jsonFile = argv[++iArg];
+    }
+  }
+
+  // filters to benchmark: each one w/o qa (decision only)
+  // and one w/ qa (decision + histogram fills)
+  //   - n.b. histograms of the latter aren't registered
+  //     with anything, so they're never written out
+  NullFilter           null;
+  NullFilter           nullQA(NullFilter::Config(), "NullQA");
+  StreakSidebandFilter sideband;
+  StreakSidebandFilter sidebandQA(StreakSidebandFilter::Config(), "SidebandQA");
+  nullQA.BuildHistograms("bench");
+  sidebandQA.BuildHistograms("bench");
+
+  // events/s of each kernel on each grid, for --json
+  std::vector<std::pair<std::string, double>> results;
+
+  // bytes touched per event (estimates): a map build resets and fills
+  // the map and reads energy + status of every channel, while the filters
+  // read every tower of the map once (neighbors come from cache)
+  const std::size_t nTowers    = bbfqd::OHCalMap::nEta * bbfqd::OHCalMap::nPhi;
+  const std::size_t mapBytes   = sizeof(bbfqd::OHCalMap);
+  const std::size_t buildBytes = (2 * mapBytes) + (nTowers * (sizeof(float) + sizeof(uint8_t)));
+
+  uint64_t sink = 0;
+  std::printf("%-18s %-14s %12s %14s %12s\n", "kernel", "grid", "ns/evt", "evts/s", "bytes/evt");
+  for (const auto& grid : MakeGrids())
+  {
+
+    // generate pool of events
+    OHCalEventGenerator                                generator(grid.second);
+    OHCalEventGenerator::Truth                         truth;
+    std::vector<bbfqd::OHCalMap>                       maps(NPool);
+    std::vector<std::unique_ptr<TowerInfoContainerv1>> containers;
+    for (std::size_t iEvt = 0; iEvt < NPool; ++iEvt)
+    {
+      generator.Generate(maps[iEvt], truth);
+      containers.push_back(std::make_unique<TowerInfoContainerv1>(TowerInfoContainer::DETECTOR::HCAL));
+      OHCalEventGenerator::FillContainer(containers.back().get(), maps[iEvt]);
+    }
+
+    // define kernels
+    bbfqd::OHCalMap built;
+    const std::vector<std::tuple<std::string, std::size_t, std::function<uint64_t(std::size_t)>>> kernels = {
+      {"generate", mapBytes, [&](const std::size_t iEvt)
+        {
+          generator.Generate(maps[iEvt], truth);
+          return static_cast<uint64_t>(truth.nPileUp);
+        }
+      },
+      {"map_build", buildBytes, [&](const std::size_t iEvt)
+        {
+          built.Reset();
+          built.Build(containers[iEvt].get());
+          return static_cast<uint64_t>(built.towers[0][0].status);
+        }
+      },
+      {"null_decision", 0, [&](const std::size_t iEvt)
+        {
+          bbfqd::TowerSnapshot snapshot;
+          snapshot.ohcal = maps[iEvt].View();
+          return static_cast<uint64_t>(null.ApplyFilterToSnapshot(snapshot));
+        }
+      },
+      {"null_qa", 0, [&](const std::size_t iEvt)
+        {
+          bbfqd::TowerSnapshot snapshot;
+          snapshot.ohcal = maps[iEvt].View();
+          nullQA.SetFillQA(true);
+          return static_cast<uint64_t>(nullQA.ApplyFilterToSnapshot(snapshot));
+        }
+      },
+      {"streak_decision", mapBytes, [&](const std::size_t iEvt)
+        {
+          bbfqd::TowerSnapshot snapshot;
+          snapshot.ohcal = maps[iEvt].View();
+          return static_cast<uint64_t>(sideband.ApplyFilterToSnapshot(snapshot));
+        }
+      },
+      {"streak_qa", mapBytes, [&](const std::size_t iEvt)
+        {
+          bbfqd::TowerSnapshot snapshot;
+          snapshot.ohcal = maps[iEvt].View();
+          sidebandQA.SetFillQA(true);
+          return static_cast<uint64_t>(sidebandQA.ApplyFilterToSnapshot(snapshot));
+        }
+      }
+    };
+
+    // and run them, keeping the fastest repeat
+    for (const auto& kernel : kernels)
+    {
+      double nsPerEvt = TimeKernel(std::get<2>(kernel), minTime, sink);
+      for (int iRepeat = 1; iRepeat < nRepeats; ++iRepeat)
+      {
+        nsPerEvt = std::min(nsPerEvt, TimeKernel(std::get<2>(kernel), minTime, sink));
+      }
+      results.emplace_back(std::get<0>(kernel) + "/" + grid.first, 1e9 / nsPerEvt);
+
+      std::printf("%-18s %-14s %12.1f %14.4g %12zu\n",
+                  std::get<0>(kernel).data(),
+                  grid.first.data(),
+                  nsPerEvt,
+                  1e9 / nsPerEvt,
+                  std::get<1>(kernel));
+    }
+  }
+
+  // if needed, write out results
+  if (!jsonFile.empty())
+  {
+    std::ofstream json(jsonFile);
+    if (!json)
+    {
+      std::fprintf(stderr, "ERROR: couldn't open '%s' for writing\n", jsonFile.data());
+      return 1;
+    }
+    json << "{\n  \"units\": \"events/s\",\n  \"kernels\": {\n";
+    for (std::size_t iResult = 0; iResult < results.size(); ++iResult)
+    {
+      json << "    \"" << results[iResult].first << "\": "
+           << std::fixed << std::setprecision(0) << results[iResult].second
+           << ((iResult + 1 < results.size()) ? ",\n" : "\n");
+    }
+    json << "  }\n}\n";
+  }
+
+  // print sink so that nothing is optimized away
+  std::printf("(checksum %llu)\n", static_cast<unsigned long long>(sink));
+  return 0;
+
+}
+
+// end ========================================================================
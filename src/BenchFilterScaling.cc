@@ -0,0 +1,381 @@
+/// ===========================================================================
+/*! \file    BenchFilterScaling.cc
+ *  \authors Derek Anderson
+ *  \date    10.16.2026
+ *
+ *  Thread-scaling benchmark of the beam background
+ *  filters: processes events concurrently on 1 up to
+ *  N threads and reports throughput, speed-up, parallel
+ *  efficiency, and per-event latency for each thread
+ *  count, i.e. without Fun4All, DSTs, or the CDB.
+ *
+ *  Usage (or just 'make bench-scaling'):
+ *    benchfilterscaling [-f <filter type>]... [-p <filter>:<key>=<value>]...
+ *                       [-j <max. threads>] [-n <events per thread count>]
+ *                       [-P <pool size>] [-q] [<tower record>]
+ *
+ *  Events come from a pool of synthetic (min-bias w/
+ *  occasional streaks) events, or from the first events
+ *  of a tower record (see TowerRecord.h) if one is given;
+ *  either way they're in memory before timing starts.
+ *  If no filters are given, the module's default set
+ *  (null + streak sideband) is run. With -q, QA
+ *  histograms are filled as well.
+ */
+/// ===========================================================================
+
+// c++ utilities
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+// module components
+#include "BaseBeamBackgroundFilter.h"
+#include "BeamBackgroundFilterAndQADefs.h"
+#include "SyntheticEventGenerator.h"
+#include "TowerRecord.h"
+
+// alias for convenience
+namespace bbfqd = BeamBackgroundFilterAndQADefs;
+
+
+
+namespace
+{
+
+  ///! no. of events each thread claims at a time
+  constexpr uint64_t NChunk = 64;
+
+  // ==========================================================================
+  //! Result of running at one thread count
+  // ==========================================================================
+  struct Result
+  {
+    std::size_t nThreads  = 1;
+    double      evtsPerS  = 0.;
+    double      p50       = 0.;
+    double      p99       = 0.;
+    uint64_t    nFlagged  = 0;
+  };
+
+
+
+  // --------------------------------------------------------------------------
+  //! Get thread counts to sweep
+  // --------------------------------------------------------------------------
+  /*! Every count up to 8, and powers of two (plus the max.) beyond that.
+   */
+  std::vector<std::size_t> GetThreadCounts(const std::size_t maxThreads)
+  {
+    std::vector<std::size_t> counts;
+    for (std::size_t nThreads = 1; nThreads <= maxThreads; nThreads = (nThreads < 8) ? nThreads + 1 : 2 * nThreads)
+    {
+      counts.push_back(nThreads);
+    }
+    if (counts.back() != maxThreads)
+    {
+      counts.push_back(maxThreads);
+    }
+    return counts;
+  }
+
+
+
+  // --------------------------------------------------------------------------
+  //! Get a quantile of some latencies
+  // --------------------------------------------------------------------------
+  double GetQuantile(std::vector<uint32_t>& latencies, const double quantile)
+  {
+    if (latencies.empty()) return 0.;
+
+    const std::size_t index = std::min(static_cast<std::size_t>(quantile * latencies.size()), latencies.size() - 1);
+    std::nth_element(latencies.begin(), latencies.begin() + index, latencies.end());
+    return latencies[index];
+  }
+
+
+
+  // --------------------------------------------------------------------------
+  //! Process events on some no. of threads
+  // --------------------------------------------------------------------------
+  /*! Each thread runs its own instances of the filters (which keep
+   *  per-event state like tower maps, and their own histograms) over
+   *  events of the shared, read-only pool, claiming NChunk events at
+   *  a time until nEvents have been processed overall. The clock
+   *  starts once every thread has warmed up on (up to NChunk events
+   *  of) the pool.
+   */
+  Result RunThreads(
+    std::vector<std::vector<std::unique_ptr<BaseBeamBackgroundFilter>>>& filters,
+    const std::vector<bbfqd::TowerSnapshot>& pool,
+    const std::size_t nThreads,
+    const uint64_t nEvents
+  ) {
+
+    std::atomic<uint64_t>              next(0);
+    std::atomic<std::size_t>           nReady(0);
+    std::atomic<bool>                  go(false);
+    std::vector<std::vector<uint32_t>> latencies(nThreads);
+    std::vector<uint64_t>              nFlagged(nThreads, 0);
+
+    auto work = [&](const std::size_t iThread)
+    {
+      std::vector<std::unique_ptr<BaseBeamBackgroundFilter>>& mine = filters[iThread];
+      latencies[iThread].reserve(nEvents);
+
+      // warm up, then wait for everyone else
+      for (std::size_t iEvt = 0; iEvt < std::min<std::size_t>(pool.size(), NChunk); ++iEvt)
+      {
+        for (auto& filter : mine)
+        {
+          filter->ApplyFilterToSnapshot(pool[iEvt]);
+        }
+      }
+      ++nReady;
+      while (!go.load(std::memory_order_acquire))
+      {
+        std::this_thread::yield();
+      }
+
+      // then claim chunks of events until there are none left
+      for (uint64_t iStart = next.fetch_add(NChunk); iStart < nEvents; iStart = next.fetch_add(NChunk))
+      {
+        const uint64_t iStop = std::min(iStart + NChunk, nEvents);
+        for (uint64_t iEvt = iStart; iEvt < iStop; ++iEvt)
+        {
+          const bbfqd::TowerSnapshot& snapshot = pool[iEvt % pool.size()];
+          const auto                  start    = std::chrono::steady_clock::now();
+
+          bool hasBkgd = false;
+          for (auto& filter : mine)
+          {
+            hasBkgd |= filter->ApplyFilterToSnapshot(snapshot);
+          }
+          latencies[iThread].push_back(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count()
+          );
+          nFlagged[iThread] += hasBkgd;
+        }
+      }
+    };
+
+    // launch threads, and start the clock once they're ready
+    std::vector<std::thread> threads;
+    for (std::size_t iThread = 0; iThread < nThreads; ++iThread)
+    {
+      threads.emplace_back(work, iThread);
+    }
+    while (nReady.load() < nThreads)
+    {
+      std::this_thread::yield();
+    }
+    const auto start = std::chrono::steady_clock::now();
+    go.store(true, std::memory_order_release);
+    for (auto& thread : threads)
+    {
+      thread.join();
+    }
+    const double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    // merge latencies and collect result
+    std::vector<uint32_t> merged;
+    merged.reserve(nEvents);
+    Result result;
+    result.nThreads = nThreads;
+    result.evtsPerS = nEvents / elapsed;
+    for (std::size_t iThread = 0; iThread < nThreads; ++iThread)
+    {
+      merged.insert(merged.end(), latencies[iThread].begin(), latencies[iThread].end());
+      result.nFlagged += nFlagged[iThread];
+    }
+    result.p50 = GetQuantile(merged, 0.50);
+    result.p99 = GetQuantile(merged, 0.99);
+    return result;
+
+  }
+
+}  // end anonymous namespace
+
+
+
+// ============================================================================
+//! Run benchmark
+// ============================================================================
+int main(int argc, char* argv[])
+{
+
+  // parse arguments
+  std::vector<std::string>                 types;
+  std::map<std::string, bbfqd::Parameters> params;
+  std::size_t                              maxThreads = std::max(std::thread::hardware_concurrency(), 1u);
+  uint64_t                                 nEvents    = 200000;
+  std::size_t                              poolSize   = 256;
+  bool                                     fillQA     = false;
+  std::string                              input      = "";
+  for (int iArg = 1; iArg < argc; ++iArg)
+  {
+    const std::string arg = argv[iArg];
+    if ((arg == "-f") && (iArg + 1 < argc))
+    {
+      types.push_back(argv[++iArg]);
+    }
+    else if ((arg == "-p") && (iArg + 1 < argc))
+    {
+      // parameters look like <filter>:<key>=<value>
+      const std::string param  = argv[++iArg];
+      const std::size_t iColon = param.find(':');
+      const std::size_t iEqual = param.find('=', iColon);
+      if ((iColon == std::string::npos) || (iEqual == std::string::npos))
+      {
+        std::fprintf(stderr, "PANIC! Bad parameter '%s' (expected <filter>:<key>=<value>)\n", param.data());
+        return 1;
+      }
+      params[param.substr(0, iColon)][param.substr(iColon + 1, iEqual - iColon - 1)] = param.substr(iEqual + 1);
+    }
+    else if ((arg == "-j") && (iArg + 1 < argc))
+    {
+      maxThreads = std::max(std::atoi(argv[++iArg]), 1);
+    }
+    else if ((arg == "-n") && (iArg + 1 < argc))
+    {
+      nEvents = std::max<uint64_t>(std::strtoull(argv[++iArg], nullptr, 10), 1);
+    }
+    else if ((arg == "-P") && (iArg + 1 < argc))
+    {
+      poolSize = std::max(std::atoi(argv[++iArg]), 1);
+    }
+    else if (arg == "-q")
+    {
+      fillQA = true;
+    }
+    else if (arg[0] != '-')
+    {
+      input = arg;
+    }
+    else
+    {
+      std::fprintf(stderr, "Usage: %s [-f <filter type>]... [-p <filter>:<key>=<value>]... [-j <max. threads>] [-n <events>] [-P <pool size>] [-q] [<tower record>]\n", argv[0]);
+      return 1;
+    }
+  }
+  if (types.empty())
+  {
+    types = {"Null", "StreakSideband"};
+  }
+
+  // fill pool of events: either decoded from a record...
+  std::vector<bbfqd::OHCalMap>       maps;
+  std::vector<TowerRecord::Event>    events;
+  std::vector<bbfqd::TowerSnapshot>  pool;
+  if (!input.empty())
+  {
+    TowerRecord::Reader reader;
+    if (!reader.Open(input))
+    {
+      std::fprintf(stderr, "PANIC! Couldn't read tower record '%s'\n", input.data());
+      return 1;
+    }
+    events.resize(std::min<uint64_t>(poolSize, reader.GetNEvents()));
+    for (std::size_t iEvt = 0; iEvt < events.size(); ++iEvt)
+    {
+      if (!reader.Read(iEvt, events[iEvt]))
+      {
+        std::fprintf(stderr, "PANIC! Couldn't read event %zu\n", iEvt);
+        return 1;
+      }
+      pool.push_back(events[iEvt].snapshot);
+    }
+  }
+
+  // ...or generated (min-bias, w/ a streak in ~1% of events)
+  else
+  {
+    OHCalEventGenerator::Config config;
+    config.streakProbability = 0.01;
+
+    OHCalEventGenerator        generator(config);
+    OHCalEventGenerator::Truth truth;
+    maps.resize(poolSize);
+    for (auto& map : maps)
+    {
+      generator.Generate(map, truth);
+      bbfqd::TowerSnapshot snapshot;
+      snapshot.ohcal = map.View();
+      pool.push_back(snapshot);
+    }
+  }
+  if (pool.empty())
+  {
+    std::fprintf(stderr, "PANIC! No events to run on\n");
+    return 1;
+  }
+
+  // create filters for each thread
+  //   - n.b. histograms are built up front (and named per
+  //     thread), since booking them isn't thread-safe
+  std::vector<std::vector<std::unique_ptr<BaseBeamBackgroundFilter>>> filters(maxThreads);
+  for (std::size_t iThread = 0; iThread < maxThreads; ++iThread)
+  {
+    for (const std::string& type : types)
+    {
+      filters[iThread].push_back(BaseBeamBackgroundFilter::CreateFilter(type, type, params[type]));
+      if (!filters[iThread].back())
+      {
+        std::fprintf(stderr, "PANIC! Unknown filter '%s'\n", type.data());
+        return 1;
+      }
+      if (fillQA)
+      {
+        filters[iThread].back()->BuildHistograms("scaling", "thread" + std::to_string(iThread));
+        filters[iThread].back()->SetFillQA(true);
+      }
+    }
+  }
+
+  // sweep thread counts
+  std::printf("Running %llu events (pool of %zu %s events) per thread count, QA %s, filters:",
+              static_cast<unsigned long long>(nEvents),
+              pool.size(),
+              input.empty() ? "synthetic" : "recorded",
+              fillQA ? "on" : "off");
+  for (const std::string& type : types)
+  {
+    std::printf(" %s", type.data());
+  }
+  std::printf("\n%8s %14s %10s %11s %12s %12s\n", "threads", "evts/s", "speed-up", "efficiency", "p50 ns/evt", "p99 ns/evt");
+
+  double   baseline = 0.;
+  uint64_t sink     = 0;
+  for (const std::size_t nThreads : GetThreadCounts(maxThreads))
+  {
+    const Result result = RunThreads(filters, pool, nThreads, nEvents);
+    if (nThreads == 1)
+    {
+      baseline = result.evtsPerS;
+    }
+    const double speedUp = result.evtsPerS / baseline;
+    std::printf("%8zu %14.4g %10.2f %11.2f %12.0f %12.0f\n",
+                nThreads,
+                result.evtsPerS,
+                speedUp,
+                speedUp / nThreads,
+                result.p50,
+                result.p99);
+    sink += result.nFlagged;
+  }
+
+  // print sink so that nothing is optimized away
+  std::printf("(flagged %llu)\n", static_cast<unsigned long long>(sink));
+  return 0;
+
+}
+
+// end ========================================================================
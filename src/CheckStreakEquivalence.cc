@@ -0,0 +1,771 @@
+/// ===========================================================================
+/*! \file    CheckStreakEquivalence.cc
+ *  \authors Derek Anderson
+ *  \date    10.16.2026
+ *
+ *  Differential check of the streak sideband filter:
+ *  runs a straightforward reference implementation of
+ *  the sideband algorithm side by side w/ the filter
+ *  (via ApplyFilterToSnapshot, ApplyFilterToBatch, and
+ *  ApplyFilter on a fake node tree) and requires the
+ *  same decisions and histogram contents on every event.
+ *
+ *  Usage (or just 'make check-equivalence'):
+ *    checkstreakequivalence [-n <events per set>] [-s <seed>]
+ *                           [<tower record>]...
+ *
+ *  Each set of events (synthetic min-bias, streaky, and
+ *  dense events, grids w/ energies right at the cuts,
+ *  and any given tower records) is run w/ and w/o hot-
+ *  tower masking. On the first event where anything
+ *  differs, that event is reported; if it differs on its
+ *  own (i.e. not because of earlier events), its grid is
+ *  also minimised to the fewest towers which still show
+ *  the difference. Exits w/ 1 if anything differed.
+ */
+/// ===========================================================================
+
+// c++ utilities
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <map>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+// root libraries
+#include <TH1.h>
+
+// module components
+#include "BeamBackgroundFilterAndQADefs.h"
+#include "FakeTowerInfoContainer.h"
+#include "StreakSidebandFilter.h"
+#include "SyntheticEventGenerator.h"
+#include "TowerRecord.h"
+
+// alias for convenience
+namespace bbfqd = BeamBackgroundFilterAndQADefs;
+
+
+
+namespace
+{
+
+  ///! filter configuration
+  typedef StreakSidebandFilter::Config Config;
+
+  ///! ohcal geometry
+  constexpr std::size_t NEta = bbfqd::OHCalMap::nEta;
+  constexpr std::size_t NPhi = bbfqd::OHCalMap::nPhi;
+
+  ///! no. of events per batch for ApplyFilterToBatch
+  constexpr std::size_t NBatch = 64;
+
+
+
+  // ==========================================================================
+  //! Reference streak sideband algorithm
+  // ==========================================================================
+  /*! Written for clarity rather than speed: plain loops, no bit masks, no
+   *  buffers, and histogram contents kept as plain arrays of cells (in
+   *  ROOT's global bin order) which are filled by value, so that none of
+   *  the filter's bookkeeping is reused. Hot towers are tracked the same
+   *  way as HotTowerTracker documents: every sampleEvery-th event is
+   *  looked at, and once half a window has been seen, towers occupied in
+   *  more than maxOccupancy of the current + previous half-windows are
+   *  masked.
+   */
+  class ReferenceStreakSideband
+  {
+
+    public:
+
+      // ----------------------------------------------------------------------
+      //! ctor accepting config
+      // ----------------------------------------------------------------------
+      ReferenceStreakSideband(const Config& config)
+        : m_config(config)
+        , m_current(NEta, std::vector<uint32_t>(NPhi, 0))
+        , m_previous(NEta, std::vector<uint32_t>(NPhi, 0))
+        , m_isHot(NEta, std::vector<bool>(NPhi, false))
+      {
+        m_hists["nmaxstreak"]         = Hist(NEta + 1, -0.5, NEta + 0.5);
+        m_hists["nstreakperphi"]      = Hist(NPhi + 1, -0.5, NPhi + 0.5);
+        m_hists["nstreaktwretavsphi"] = Hist(NEta + 1, -0.5, NEta + 0.5, NPhi + 1, -0.5, NPhi + 0.5);
+      }
+
+      // ----------------------------------------------------------------------
+      //! Check an event for streaks
+      // ----------------------------------------------------------------------
+      bool Apply(const bbfqd::TowerView& view)
+      {
+        // observe towers for hot-tower masking
+        if (m_config.maskHotTowers)
+        {
+          Observe(view);
+        }
+
+        // views which don't fit the ohcal have nothing to find
+        if (!view.IsValid() || (view.nEta > NEta) || (view.nPhi > NPhi))
+        {
+          return false;
+        }
+
+        // count streaky towers in each phi slice and the one above it
+        std::vector<uint32_t> nStreak(NPhi, 0);
+        for (std::size_t iPhi = 0; iPhi < view.nPhi; ++iPhi)
+        {
+          const std::size_t iUp   = (iPhi + 1) % view.nPhi;
+          const std::size_t iDown = (iPhi + view.nPhi - 1) % view.nPhi;
+          for (std::size_t iEta = 0; iEta < view.nEta; ++iEta)
+          {
+            if (!IsCandidate(view.At(iEta, iPhi), m_isHot[iEta][iPhi])) continue;
+            if (!IsQuietNeighbor(view.At(iEta, iUp), m_isHot[iEta][iUp])) continue;
+            if (!IsQuietNeighbor(view.At(iEta, iDown), m_isHot[iEta][iDown])) continue;
+
+            ++nStreak[iPhi];
+            ++nStreak[iUp];
+            m_hists["nstreakperphi"].Fill(iPhi);
+            m_hists["nstreakperphi"].Fill(iPhi);
+            m_hists["nstreaktwretavsphi"].Fill(iEta, iPhi);
+            m_hists["nstreaktwretavsphi"].Fill(iEta, iUp);
+          }
+        }
+
+        // event has a streak if the longest one is long enough
+        uint32_t nMaxStreak = 0;
+        for (const uint32_t n : nStreak)
+        {
+          nMaxStreak = std::max(nMaxStreak, n);
+        }
+        m_hists["nmaxstreak"].Fill(nMaxStreak);
+        return (nMaxStreak > m_config.minNumTwrsInStreak);
+      }
+
+      // ======================================================================
+      //! Fixed-width 1D or 2D histogram (nBinsY = 0 for 1D)
+      // ======================================================================
+      struct Hist
+      {
+        std::size_t         nBinsX = 1;
+        double              xMin   = 0.;
+        double              xMax   = 1.;
+        std::size_t         nBinsY = 0;
+        double              yMin   = 0.;
+        double              yMax   = 1.;
+        std::vector<double> cells;
+
+        Hist() = default;
+        Hist(std::size_t nx, double x0, double x1, std::size_t ny = 0, double y0 = 0., double y1 = 1.)
+          : nBinsX(nx), xMin(x0), xMax(x1), nBinsY(ny), yMin(y0), yMax(y1)
+          , cells((nx + 2) * ((ny > 0) ? (ny + 2) : 1), 0.)
+        {}
+
+        ///! bin (incl. under-/overflow) of a value on an axis
+        static std::size_t Bin(const double value, const std::size_t nBins, const double min, const double max)
+        {
+          if (value < min)  return 0;
+          if (value >= max) return nBins + 1;
+          return 1 + static_cast<std::size_t>(std::floor(((value - min) * nBins) / (max - min)));
+        }
+
+        void Fill(const double x) {++cells[Bin(x, nBinsX, xMin, xMax)];}
+        void Fill(const double x, const double y)
+        {
+          ++cells[Bin(x, nBinsX, xMin, xMax) + ((nBinsX + 2) * Bin(y, nBinsY, yMin, yMax))];
+        }
+      };
+
+      ///! get histograms, keyed like the filter's histograms
+      const std::map<std::string, Hist>& GetHists() const {return m_hists;}
+
+    private:
+
+      ///! check if a tower could be part of a streak
+      bool IsCandidate(const bbfqd::Tower& tower, const bool isHot) const
+      {
+        return (tower.status == 1) && !isHot && (tower.energy >= m_config.minStreakTwrEne);
+      }
+
+      ///! check if a tower is quiet enough to flank a streak
+      bool IsQuietNeighbor(const bbfqd::Tower& tower, const bool isHot) const
+      {
+        return (tower.status == 1) && !isHot && (tower.energy <= m_config.maxAdjacentTwrEne);
+      }
+
+      // ----------------------------------------------------------------------
+      //! Update hot-tower occupancies (and mask)
+      // ----------------------------------------------------------------------
+      void Observe(const bbfqd::TowerView& view)
+      {
+        const uint32_t sampleEvery = std::max<uint32_t>(m_config.hotTowerSampleEvery, 1);
+        const uint32_t halfWindow  = std::max<uint32_t>(m_config.hotTowerWindow / 2, 1);
+        if (((m_nCalls++) % sampleEvery) != 0) return;
+        if (!view.IsValid() || (view.nEta > NEta) || (view.nPhi > NPhi)) return;
+
+        for (std::size_t iEta = 0; iEta < view.nEta; ++iEta)
+        {
+          for (std::size_t iPhi = 0; iPhi < view.nPhi; ++iPhi)
+          {
+            if (view.At(iEta, iPhi).energy > m_config.hotTowerMinEne)
+            {
+              ++m_current[iEta][iPhi];
+            }
+          }
+        }
+        if (++m_nCurrent < halfWindow) return;
+
+        // half a window is in, so recompute mask and roll over
+        const double nMax = m_config.hotTowerMaxOccupancy * (m_nCurrent + m_nPrevious);
+        for (std::size_t iEta = 0; iEta < NEta; ++iEta)
+        {
+          for (std::size_t iPhi = 0; iPhi < NPhi; ++iPhi)
+          {
+            m_isHot[iEta][iPhi] = ((m_current[iEta][iPhi] + m_previous[iEta][iPhi]) > nMax);
+          }
+        }
+        m_previous  = m_current;
+        m_nPrevious = m_nCurrent;
+        m_current.assign(NEta, std::vector<uint32_t>(NPhi, 0));
+        m_nCurrent  = 0;
+      }
+
+      ///! configuration
+      Config m_config;
+
+      ///! hot-tower bookkeeping
+      std::vector<std::vector<uint32_t>> m_current;
+      std::vector<std::vector<uint32_t>> m_previous;
+      std::vector<std::vector<bool>>     m_isHot;
+      uint64_t                           m_nCalls    = 0;
+      uint32_t                           m_nCurrent  = 0;
+      uint32_t                           m_nPrevious = 0;
+
+      ///! histograms
+      std::map<std::string, Hist> m_hists;
+
+  };  // end ReferenceStreakSideband
+
+
+
+  // ==========================================================================
+  //! Reference + every path through the filter, run side by side
+  // ==========================================================================
+  /*! Events go to the reference, ApplyFilterToSnapshot, and ApplyFilter
+   *  (on a fake node tree) one at a time, and to ApplyFilterToBatch in
+   *  batches of up to NBatch. Histograms aren't registered anywhere, so
+   *  they're deleted along w/ the filters.
+   */
+  class SideBySide
+  {
+
+    public:
+
+      // ----------------------------------------------------------------------
+      //! ctor accepting config
+      // ----------------------------------------------------------------------
+      SideBySide(const Config& config)
+        : m_reference(config)
+      {
+        for (const char* path : {"snapshot", "batch", "node"})
+        {
+          m_filters.push_back(std::make_unique<StreakSidebandFilter>(config, path));
+          m_filters.back()->BuildHistograms("equivalence");
+          m_filters.back()->SetFillQA(true);
+        }
+        m_container = m_tree.AddTowers(config.inNodeName, NEta, NPhi);
+      }
+
+      ~SideBySide()
+      {
+        for (auto& filter : m_filters)
+        {
+          for (auto& hist : filter->GetHistograms())
+          {
+            delete hist.second;
+          }
+        }
+      }
+
+      // ----------------------------------------------------------------------
+      //! Run a batch of events, and describe the first difference (if any)
+      // ----------------------------------------------------------------------
+      /*! Returns an empty string if everything matched, and otherwise sets
+       *  iFirst to the event (in the batch) where things first differed.
+       *  Decisions of each path and histograms of the one-at-a-time paths
+       *  are checked after every event; histograms of the batch path can
+       *  only be checked after the whole batch, so a difference there is
+       *  put on the last event.
+       */
+      std::string Run(const std::vector<bbfqd::OHCalMap>& maps, std::size_t& iFirst)
+      {
+        std::vector<bbfqd::TowerSnapshot> snapshots(maps.size());
+        for (std::size_t iEvt = 0; iEvt < maps.size(); ++iEvt)
+        {
+          snapshots[iEvt].ohcal = maps[iEvt].View();
+        }
+
+        std::vector<uint8_t> batchDecisions(snapshots.size());
+        m_filters[1]->ApplyFilterToBatch(snapshots.data(), snapshots.size(), batchDecisions.data());
+
+        for (std::size_t iEvt = 0; iEvt < maps.size(); ++iEvt)
+        {
+          iFirst = iEvt;
+
+          m_container->Fill(maps[iEvt]);
+          const bool reference = m_reference.Apply(snapshots[iEvt].ohcal);
+          const bool decisions[] = {
+            m_filters[0]->ApplyFilterToSnapshot(snapshots[iEvt]),
+            batchDecisions[iEvt] == 1,
+            m_filters[2]->ApplyFilter(m_tree.GetTopNode())
+          };
+          for (std::size_t iPath = 0; iPath < m_filters.size(); ++iPath)
+          {
+            if (decisions[iPath] != reference)
+            {
+              return m_filters[iPath]->GetName() + " decision " + std::to_string(decisions[iPath]) +
+                     " vs. reference " + std::to_string(reference);
+            }
+          }
+
+          for (const std::size_t iPath : {std::size_t(0), std::size_t(2)})
+          {
+            const std::string difference = CompareHists(*m_filters[iPath], m_reference.GetHists());
+            if (!difference.empty()) return difference;
+          }
+          if (iEvt + 1 == maps.size())
+          {
+            const std::string difference = CompareHists(*m_filters[1], m_reference.GetHists());
+            if (!difference.empty()) return difference;
+          }
+        }
+        return "";
+      }
+
+    private:
+
+      // ----------------------------------------------------------------------
+      //! Compare a filter's histograms against reference contents
+      // ----------------------------------------------------------------------
+      static std::string CompareHists(
+        StreakSidebandFilter& filter,
+        const std::map<std::string, ReferenceStreakSideband::Hist>& contents
+      ) {
+        filter.MergeHistograms();
+        for (const auto& expected : contents)
+        {
+          auto found = filter.GetHistograms().find(expected.first);
+          if (found == filter.GetHistograms().end())
+          {
+            return filter.GetName() + " has no histogram '" + expected.first + "'";
+          }
+
+          TH1* hist = found->second;
+          const std::vector<double>& cells = expected.second.cells;
+          if (static_cast<std::size_t>(hist->GetNcells()) != cells.size())
+          {
+            return filter.GetName() + " histogram '" + expected.first + "' has " + std::to_string(hist->GetNcells()) +
+                   " cells vs. reference " + std::to_string(cells.size());
+          }
+          for (std::size_t iCell = 0; iCell < cells.size(); ++iCell)
+          {
+            if (hist->GetBinContent(iCell) != cells[iCell])
+            {
+              return filter.GetName() + " histogram '" + expected.first + "' cell " + std::to_string(iCell) + ": " +
+                     std::to_string(hist->GetBinContent(iCell)) + " vs. reference " + std::to_string(cells[iCell]);
+            }
+          }
+        }
+        return "";
+      }
+
+      ///! reference
+      ReferenceStreakSideband m_reference;
+
+      ///! filter for each path, and tree + container for the node path
+      std::vector<std::unique_ptr<StreakSidebandFilter>> m_filters;
+      FakeNodeTree                                       m_tree;
+      FakeTowerInfoContainer*                            m_container;
+
+  };  // end SideBySide
+
+
+
+  // --------------------------------------------------------------------------
+  //! Check if a single event differs on fresh filters
+  // --------------------------------------------------------------------------
+  std::string DiffersAlone(const Config& config, const bbfqd::OHCalMap& map)
+  {
+    SideBySide  sideBySide(config);
+    std::size_t iFirst = 0;
+    return sideBySide.Run({map}, iFirst);
+  }
+
+
+
+  // --------------------------------------------------------------------------
+  //! Get the kind of a difference
+  // --------------------------------------------------------------------------
+  /*! I.e. which path differed, and in its decision (and which way) or in
+   *  which histogram, but not by how much.
+   */
+  std::string KindOf(const std::string& difference)
+  {
+    const std::size_t iHist = difference.find(" histogram '");
+    if (iHist != std::string::npos)
+    {
+      return difference.substr(0, difference.find('\'', iHist + 12) + 1);
+    }
+    return difference.substr(0, difference.find(" vs."));
+  }
+
+
+
+  // --------------------------------------------------------------------------
+  //! Minimise a grid which differs on its own
+  // --------------------------------------------------------------------------
+  /*! Greedily blanks out (status 1, no energy) chunks of towers, halving
+   *  the chunk size whenever no chunk can be blanked, until no single
+   *  tower can be blanked w/o the difference going away. Only the same
+   *  kind of difference counts, so that e.g. a decision mismatch doesn't
+   *  get minimised into a (smaller) histogram mismatch.
+   */
+  bbfqd::OHCalMap Minimise(const Config& config, const bbfqd::OHCalMap& map, const std::string& difference)
+  {
+    const std::string kind = KindOf(difference);
+    auto sameKind = [&](const bbfqd::OHCalMap& grid)
+    {
+      const std::string found = DiffersAlone(config, grid);
+      return !found.empty() && (KindOf(found) == kind);
+    };
+    auto isBlank = [](const bbfqd::Tower& tower) {return (tower.status == 1) && (tower.energy == 0.);};
+    auto build   = [](const std::vector<std::pair<std::size_t, bbfqd::Tower>>& towers)
+    {
+      bbfqd::OHCalMap built;
+      for (auto& row : built.towers)
+      {
+        for (auto& tower : row)
+        {
+          tower.status = 1;
+          tower.energy = 0.;
+        }
+      }
+      for (const auto& tower : towers)
+      {
+        built.towers[tower.first / NPhi][tower.first % NPhi] = tower.second;
+      }
+      return built;
+    };
+
+    // collect towers which aren't blank
+    std::vector<std::pair<std::size_t, bbfqd::Tower>> kept;
+    for (std::size_t iEta = 0; iEta < NEta; ++iEta)
+    {
+      for (std::size_t iPhi = 0; iPhi < NPhi; ++iPhi)
+      {
+        if (!isBlank(map.towers[iEta][iPhi]))
+        {
+          kept.emplace_back((iEta * NPhi) + iPhi, map.towers[iEta][iPhi]);
+        }
+      }
+    }
+    if (!sameKind(build(kept)))
+    {
+      return map;
+    }
+
+    // and blank out as many as possible
+    for (std::size_t chunk = std::max<std::size_t>(kept.size() / 2, 1); (chunk > 0) && !kept.empty(); )
+    {
+      bool blanked = false;
+      for (std::size_t iStart = 0; iStart < kept.size(); )
+      {
+        std::vector<std::pair<std::size_t, bbfqd::Tower>> candidate(kept.begin(), kept.begin() + iStart);
+        candidate.insert(candidate.end(), kept.begin() + std::min(iStart + chunk, kept.size()), kept.end());
+        if (sameKind(build(candidate)))
+        {
+          kept    = candidate;
+          blanked = true;
+        }
+        else
+        {
+          iStart += chunk;
+        }
+      }
+      if (!blanked)
+      {
+        chunk /= 2;
+      }
+    }
+    return build(kept);
+  }
+
+
+
+  // --------------------------------------------------------------------------
+  //! Print a grid as a list of its non-blank towers
+  // --------------------------------------------------------------------------
+  void PrintGrid(const bbfqd::OHCalMap& map)
+  {
+    std::size_t nKept = 0;
+    for (std::size_t iEta = 0; iEta < NEta; ++iEta)
+    {
+      for (std::size_t iPhi = 0; iPhi < NPhi; ++iPhi)
+      {
+        const bbfqd::Tower& tower = map.towers[iEta][iPhi];
+        if ((tower.status == 1) && (tower.energy == 0.)) continue;
+        std::printf("      {%2zu, %2zu, %u, %.9g},  // {iEta, iPhi, status, energy}\n", iEta, iPhi, tower.status, tower.energy);
+        ++nKept;
+      }
+    }
+    std::printf("    (%zu of %zu towers; all others have status 1 and no energy)\n", nKept, NEta * NPhi);
+  }
+
+
+
+  // --------------------------------------------------------------------------
+  //! Make grids w/ energies right at (and next to) the cuts
+  // --------------------------------------------------------------------------
+  /*! Towers are mostly quiet, w/ some phi slices seeded w/ candidates and
+   *  neighbors whose energies are exactly at, or one float away from, the
+   *  candidate and neighbor thresholds, and a few towers w/ bad status.
+   */
+  void MakeBoundaryGrid(std::mt19937_64& rng, const Config& config, bbfqd::OHCalMap& map)
+  {
+    const float minCand = config.minStreakTwrEne;
+    const float maxAdj  = config.maxAdjacentTwrEne;
+    const std::vector<double> candEnes = {minCand, std::nextafter(minCand, 0.f), std::nextafter(minCand, 10.f), 2. * minCand};
+    const std::vector<double> adjEnes  = {0., maxAdj, std::nextafter(maxAdj, 0.f), std::nextafter(maxAdj, 10.f), -1.};
+
+    std::uniform_real_distribution<double> uniform(0., 1.);
+    for (std::size_t iEta = 0; iEta < NEta; ++iEta)
+    {
+      for (std::size_t iPhi = 0; iPhi < NPhi; ++iPhi)
+      {
+        bbfqd::Tower& tower = map.towers[iEta][iPhi];
+        tower.status = (uniform(rng) < 0.03) ? ((uniform(rng) < 0.5) ? 0 : 2) : 1;
+        tower.energy = adjEnes[rng() % adjEnes.size()];
+      }
+    }
+
+    // seed a few slices w/ candidates
+    const std::size_t nSlices = 1 + (rng() % 4);
+    for (std::size_t iSlice = 0; iSlice < nSlices; ++iSlice)
+    {
+      const std::size_t iPhi     = rng() % NPhi;
+      const std::size_t length   = 1 + (rng() % NEta);
+      const std::size_t etaStart = rng() % (NEta - length + 1);
+      for (std::size_t iEta = etaStart; iEta < etaStart + length; ++iEta)
+      {
+        map.towers[iEta][iPhi].energy = candEnes[rng() % candEnes.size()];
+      }
+    }
+  }
+
+}  // end anonymous namespace
+
+
+
+// ============================================================================
+//! Run equivalence checks
+// ============================================================================
+int main(int argc, char* argv[])
+{
+
+  // parse arguments
+  uint64_t                 nEvents = 5000;
+  uint64_t                 seed    = 1;
+  std::vector<std::string> records;
+  for (int iArg = 1; iArg < argc; ++iArg)
+  {
+    const std::string arg = argv[iArg];
+    if ((arg == "-n") && (iArg + 1 < argc))
+    {
+      nEvents = std::strtoull(argv[++iArg], nullptr, 10);
+    }
+    else if ((arg == "-s") && (iArg + 1 < argc))
+    {
+      seed = std::strtoull(argv[++iArg], nullptr, 10);
+    }
+    else if (arg[0] != '-')
+    {
+      records.push_back(arg);
+    }
+    else
+    {
+      std::fprintf(stderr, "Usage: %s [-n <events per set>] [-s <seed>] [<tower record>]...\n", argv[0]);
+      return 1;
+    }
+  }
+
+  // histograms are owned here, not by a directory
+  TH1::AddDirectory(false);
+
+  // configurations to check: defaults, and hot-tower masking
+  // w/ a short window so that the mask changes often
+  Config masked;
+  masked.maskHotTowers        = true;
+  masked.hotTowerWindow       = 20;
+  masked.hotTowerSampleEvery  = 2;
+  masked.hotTowerMaxOccupancy = 0.2;
+  const std::vector<std::pair<std::string, Config>> configs = {
+    {"default", Config()},
+    {"masked",  masked}
+  };
+
+  // sets of events to check: each fills a map w/ the i-th
+  // event, returning false once there are no more
+  typedef std::function<bool(uint64_t, bbfqd::OHCalMap&)> Source;
+  std::vector<std::pair<std::string, std::function<Source(const Config&)>>> sets;
+
+  OHCalEventGenerator::Config minBias;
+  minBias.streakProbability = 0.05;
+
+  OHCalEventGenerator::Config streaky;
+  streaky.streakProbability = 0.5;
+  streaky.minStreakLength   = 3;
+  streaky.maxStreakTilt     = 0.5;
+  streaky.streakEneSpread   = 0.5;
+  streaky.badStatusFraction = 0.05;
+
+  OHCalEventGenerator::Config dense;
+  dense.pileUpOccupancy = 0.6;
+  dense.pileUpMeanEne   = 1.0;
+
+  for (const auto& generated : {std::make_pair("minbias", minBias), std::make_pair("streaky", streaky), std::make_pair("dense", dense)})
+  {
+    OHCalEventGenerator::Config config = generated.second;
+    config.seed = seed;
+    sets.emplace_back(generated.first, [config, nEvents](const Config&)
+    {
+      auto generator = std::make_shared<OHCalEventGenerator>(config);
+      return Source([generator, nEvents](const uint64_t iEvt, bbfqd::OHCalMap& map)
+      {
+        OHCalEventGenerator::Truth truth;
+        generator->Generate(map, truth);
+        return (iEvt < nEvents);
+      });
+    });
+  }
+
+  sets.emplace_back("boundary", [seed, nEvents](const Config& config)
+  {
+    auto rng = std::make_shared<std::mt19937_64>(seed);
+    return Source([rng, config, nEvents](const uint64_t iEvt, bbfqd::OHCalMap& map)
+    {
+      MakeBoundaryGrid(*rng, config, map);
+      return (iEvt < nEvents);
+    });
+  });
+
+  for (const std::string& record : records)
+  {
+    sets.emplace_back(record, [record](const Config&)
+    {
+      auto reader = std::make_shared<TowerRecord::Reader>();
+      auto event  = std::make_shared<TowerRecord::Event>();
+      if (!reader->Open(record))
+      {
+        std::fprintf(stderr, "PANIC! Couldn't read tower record '%s'\n", record.data());
+        std::exit(1);
+      }
+      return Source([reader, event](const uint64_t iEvt, bbfqd::OHCalMap& map)
+      {
+        if ((iEvt >= reader->GetNEvents()) || !reader->Read(iEvt, *event)) return false;
+
+        const bbfqd::TowerView& view = event->snapshot.ohcal;
+        map.Reset();
+        for (std::size_t iEta = 0; (iEta < view.nEta) && (iEta < NEta); ++iEta)
+        {
+          for (std::size_t iPhi = 0; (iPhi < view.nPhi) && (iPhi < NPhi); ++iPhi)
+          {
+            map.towers[iEta][iPhi] = view.At(iEta, iPhi);
+          }
+        }
+        return true;
+      });
+    });
+  }
+
+  // run every set w/ every configuration
+  bool allMatch = true;
+  for (const auto& set : sets)
+  {
+    for (const auto& config : configs)
+    {
+      SideBySide                   sideBySide(config.second);
+      Source                       source = set.second(config.second);
+      std::vector<bbfqd::OHCalMap> maps;
+      uint64_t                     nRun   = 0;
+      std::string                  difference;
+      std::size_t                  iFirst = 0;
+
+      // n.b. real towers hold float energies, so events are
+      // rounded to them (otherwise the node path, which goes
+      // through TowerInfo, would see slightly different ones)
+      bbfqd::OHCalMap map;
+      auto next = [&](const uint64_t iEvt)
+      {
+        const bool more = source(iEvt, map);
+        for (auto& row : map.towers)
+        {
+          for (auto& tower : row)
+          {
+            tower.energy = static_cast<float>(tower.energy);
+          }
+        }
+        return more;
+      };
+
+      for (bool more = next(0); more; )
+      {
+        maps.clear();
+        while (more && (maps.size() < NBatch))
+        {
+          maps.push_back(map);
+          more = next(nRun + maps.size());
+        }
+        difference = sideBySide.Run(maps, iFirst);
+        if (!difference.empty()) break;
+        nRun += maps.size();
+      }
+
+      if (difference.empty())
+      {
+        std::printf("%-12s %-8s %10llu events  OK\n", set.first.data(), config.first.data(), static_cast<unsigned long long>(nRun));
+        continue;
+      }
+
+      // report first difference, and try to reproduce it on its own
+      allMatch = false;
+      std::printf("%-12s %-8s MISMATCH at event %llu: %s\n",
+                  set.first.data(),
+                  config.first.data(),
+                  static_cast<unsigned long long>(nRun + iFirst),
+                  difference.data());
+
+      const std::string alone = DiffersAlone(config.second, maps[iFirst]);
+      if (alone.empty())
+      {
+        std::printf("    event matches on fresh filters, so the difference depends on earlier events\n"
+                    "    (e.g. hot-tower history, or histograms of a whole batch); rerun w/ -n %llu to reproduce\n",
+                    static_cast<unsigned long long>(nRun + iFirst + 1));
+        continue;
+      }
+      const bbfqd::OHCalMap minimised = Minimise(config.second, maps[iFirst], alone);
+      std::printf("    on its own: %s\n    minimised grid (%s):\n",
+                  alone.data(),
+                  DiffersAlone(config.second, minimised).data());
+      PrintGrid(minimised);
+    }
+  }
+  return allMatch ? 0 : 1;
+
+}
+
+// end ========================================================================
@@ -0,0 +1,222 @@
+/// ===========================================================================
+/*! \file    FakeTowerInfoContainer.h
+ *  \authors Derek Anderson
+ *  \date    10.16.2026
+ *
+ *  Part of the BeamBackgroundFilterAndQA module, this
+ *  provides a lightweight, in-memory stand-in for a
+ *  TowerInfoContainer and a node tree to put it in, so
+ *  that filters can be run through ApplyFilter on
+ *  constructed events without DSTs.
+ */
+/// ===========================================================================
+
+#ifndef FAKETOWERINFOCONTAINER_H
+#define FAKETOWERINFOCONTAINER_H
+
+// c++ utilities
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+// calo base
+#include <calobase/TowerInfoContainer.h>
+#include <calobase/TowerInfov1.h>
+
+// phool libraries
+#include <phool/PHCompositeNode.h>
+#include <phool/PHIODataNode.h>
+#include <phool/PHObject.h>
+
+// module components
+#include "BeamBackgroundFilterAndQADefs.h"
+
+
+
+// ============================================================================
+//! In-memory tower container
+// ============================================================================
+/*! A TowerInfoContainer w/ an (eta, phi) grid of towers stored flat, so
+ *  that channel = (iEta * nPhi) + iPhi and key = (iEta << 16) + iPhi
+ *  (i.e. what TowerInfoContainer::getTower{Eta,Phi}Bin expect). Unlike
+ *  a real container, it doesn't follow any detector's channel mapping
+ *  and can't be written out; it only needs to look like one to code
+ *  reading towers, e.g.
+ *
+ *    FakeTowerInfoContainer towers(24, 64);
+ *    towers.SetTower(3, 10, 1.2);
+ *    towers.Fill(ohMap);
+ *
+ *  Setting a whole grid is a single pass over the towers, so events can
+ *  be made in microseconds.
+ */
+class FakeTowerInfoContainer : public TowerInfoContainer
+{
+
+  public:
+
+    // ------------------------------------------------------------------------
+    //! ctor accepting grid size
+    // ------------------------------------------------------------------------
+    /*! All towers start w/ zero energy and status.
+     */
+    FakeTowerInfoContainer(const uint32_t nEta, const uint32_t nPhi)
+      : m_nEta(nEta)
+      , m_nPhi(nPhi)
+      , m_towers(static_cast<std::size_t>(nEta) * nPhi)
+    {}
+
+    ~FakeTowerInfoContainer() override {}
+
+    // ------------------------------------------------------------------------
+    //! Set energy and status of one tower
+    // ------------------------------------------------------------------------
+    void SetTower(const uint32_t iEta, const uint32_t iPhi, const float energy, const uint8_t status = 1)
+    {
+      TowerInfov1& tower = m_towers[(static_cast<std::size_t>(iEta) * m_nPhi) + iPhi];
+      tower.set_energy(energy);
+      tower.set_status(status);
+    }
+
+    // ------------------------------------------------------------------------
+    //! Set all towers from an (eta, phi) map
+    // ------------------------------------------------------------------------
+    /*! Towers outside of the map (or of the container) are left as is.
+     */
+    template <std::size_t H, std::size_t F> void Fill(const BeamBackgroundFilterAndQADefs::TowerMap<H, F>& map)
+    {
+      for (uint32_t iEta = 0; (iEta < m_nEta) && (iEta < H); ++iEta)
+      {
+        for (uint32_t iPhi = 0; (iPhi < m_nPhi) && (iPhi < F); ++iPhi)
+        {
+          SetTower(iEta, iPhi, map.towers[iEta][iPhi].energy, map.towers[iEta][iPhi].status);
+        }
+      }
+    }
+
+    ///! get grid size
+    uint32_t GetNEta() const {return m_nEta;}
+    uint32_t GetNPhi() const {return m_nPhi;}
+
+    // ------------------------------------------------------------------------
+    //! Zero all towers
+    // ------------------------------------------------------------------------
+    void Reset() override
+    {
+      for (TowerInfov1& tower : m_towers)
+      {
+        tower.set_energy(0.);
+        tower.set_status(0);
+      }
+    }
+
+    // inherited container interface
+    void identify(std::ostream& os = std::cout) const override
+    {
+      os << "FakeTowerInfoContainer: " << m_nEta << " x " << m_nPhi << " towers" << std::endl;
+    }
+
+    std::size_t size() override {return m_towers.size();}
+
+    TowerInfo* get_tower_at_channel(int channel) override
+    {
+      return ((channel >= 0) && (static_cast<std::size_t>(channel) < m_towers.size())) ? &m_towers[channel] : nullptr;
+    }
+
+    TowerInfo* get_tower_at_key(int key) override
+    {
+      return get_tower_at_channel(decode_key(key));
+    }
+
+    unsigned int encode_key(unsigned int channel) override
+    {
+      return ((channel / m_nPhi) << 16U) + (channel % m_nPhi);
+    }
+
+    unsigned int decode_key(unsigned int key) override
+    {
+      return (getTowerEtaBin(key) * m_nPhi) + getTowerPhiBin(key);
+    }
+
+  private:
+
+    ///! grid size
+    uint32_t m_nEta;
+    uint32_t m_nPhi;
+
+    ///! towers, indexed by channel
+    std::vector<TowerInfov1> m_towers;
+
+};  // end FakeTowerInfoContainer
+
+
+
+// ============================================================================
+//! Minimal node tree to hold fake containers
+// ============================================================================
+/*! Builds TOP/DST and puts containers under DST, so that they're found by
+ *  findNode::getClass like the real ones, e.g.
+ *
+ *    FakeNodeTree tree;
+ *    FakeTowerInfoContainer* ohcal = tree.AddTowers("TOWERINFO_CALIB_HCALOUT", 24, 64);
+ *    ohcal->Fill(ohMap);
+ *    filter.ApplyFilter(tree.GetTopNode());
+ *
+ *  The tree owns the nodes, which own the containers.
+ */
+class FakeNodeTree
+{
+
+  public:
+
+    // ------------------------------------------------------------------------
+    //! Default ctor
+    // ------------------------------------------------------------------------
+    FakeNodeTree()
+      : m_top(std::make_unique<PHCompositeNode>("TOP"))
+      , m_dst(new PHCompositeNode("DST"))
+    {
+      m_top->addNode(m_dst);
+    }
+
+    // no copying: this owns the nodes
+    FakeNodeTree(const FakeNodeTree&) = delete;
+    FakeNodeTree& operator=(const FakeNodeTree&) = delete;
+
+    // ------------------------------------------------------------------------
+    //! Add an empty container of some grid size under a node name
+    // ------------------------------------------------------------------------
+    FakeTowerInfoContainer* AddTowers(const std::string& node, const uint32_t nEta, const uint32_t nPhi)
+    {
+      FakeTowerInfoContainer* container = new FakeTowerInfoContainer(nEta, nPhi);
+      m_dst->addNode(new PHIODataNode<PHObject>(container, node, "PHObject"));
+      return container;
+    }
+
+    // ------------------------------------------------------------------------
+    //! Add a container filled from an (eta, phi) map under a node name
+    // ------------------------------------------------------------------------
+    template <std::size_t H, std::size_t F> FakeTowerInfoContainer* AddTowers(
+      const std::string& node,
+      const BeamBackgroundFilterAndQADefs::TowerMap<H, F>& map
+    ) {
+      FakeTowerInfoContainer* container = AddTowers(node, H, F);
+      container->Fill(map);
+      return container;
+    }
+
+    ///! get top node to pass to modules/filters
+    PHCompositeNode* GetTopNode() {return m_top.get();}
+
+  private:
+
+    ///! top node, and dst node (owned by top) which holds containers
+    std::unique_ptr<PHCompositeNode> m_top;
+    PHCompositeNode*                 m_dst;
+
+};  // end FakeNodeTree
+
+#endif
+
+// end ========================================================================
@@ -0,0 +1,197 @@
+/// ===========================================================================
+/*! \file    FilterPipeline.h
+ *  \authors Derek Anderson
+ *  \date    10.16.2026
+ *
+ *  Part of the BeamBackgroundFilterAndQA module, this
+ *  combines several filters at compile time for use
+ *  in analysis modules.
+ */
+/// ===========================================================================
+
+#ifndef FILTERPIPELINE_H
+#define FILTERPIPELINE_H
+
+// c++ utilities
+#include <array>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+// calo base
+#include <calobase/TowerInfoContainer.h>
+
+// phool libraries
+#include <phool/getClass.h>
+#include <phool/PHCompositeNode.h>
+
+// f4a libraries
+#include <fun4all/Fun4AllHistoManager.h>
+
+// module components
+#include "BaseBeamBackgroundFilter.h"
+#include "BeamBackgroundFilterAndQADefs.h"
+
+// alias for convenience
+namespace bbfqd = BeamBackgroundFilterAndQADefs;
+
+
+
+// ============================================================================
+//! Statically-dispatched pipeline of filters
+// ============================================================================
+/*! An alternative to the BeamBackgroundFilterAndQA module for analysis
+ *  modules which embed filters directly. The filters are fixed at compile
+ *  time, so each stage is called through its concrete type (filters
+ *  should be marked `final`), i.e. w/o a virtual call. Since the filters'
+ *  kernels are defined in their .cc files, the calls themselves are only
+ *  inlined w/ link-time optimization (e.g. -flto). The tower maps are
+ *  built once per event and shared between all stages, e.g.
+ *
+ *    FilterPipeline<StreakSidebandFilter, NullFilter>::Config cfg_pipe;
+ *    cfg_pipe.ohcalNode = "TOWERINFO_CALIB_HCALOUT";
+ *
+ *    FilterPipeline<StreakSidebandFilter, NullFilter> pipeline(
+ *      cfg_pipe,
+ *      StreakSidebandFilter(cfg, "MySideband"),
+ *      NullFilter("MyNull")
+ *    );
+ *    pipeline.BuildHistograms("MyModule");
+ *    ...
+ *    const bool foundBkgd = pipeline.ApplyFilters(topNode);
+ *
+ *  Maps are only built for calorimeters with a non-empty node name.
+ */
+template <typename... Filters> class FilterPipeline
+{
+
+  static_assert(
+    (std::is_base_of_v<BaseBeamBackgroundFilter, Filters> && ...),
+    "FilterPipeline: all filters must inherit from BaseBeamBackgroundFilter"
+  );
+
+  public:
+
+    // ========================================================================
+    //! User options for pipeline
+    // ========================================================================
+    struct Config
+    {
+      std::string emcalNode = "";
+      std::string ihcalNode = "";
+      std::string ohcalNode = "TOWERINFO_CALIB_HCALOUT";
+    };
+
+    ///! number of stages
+    static constexpr std::size_t NFilters = sizeof...(Filters);
+
+    // ------------------------------------------------------------------------
+    //! ctor accepting config and filters
+    // ------------------------------------------------------------------------
+    FilterPipeline(const Config& config, Filters... filters)
+      : m_config(config)
+      , m_filters(std::move(filters)...)
+    {
+      m_decisions.fill(false);
+    }
+
+    // ------------------------------------------------------------------------
+    //! Apply all filters to an event on the node tree
+    // ------------------------------------------------------------------------
+    /*! Builds the needed tower maps once, then runs every stage on them.
+     *  Returns true if any stage finds beam background.
+     */
+    bool ApplyFilters(PHCompositeNode* topNode)
+    {
+      bbfqd::TowerSnapshot snapshot;
+      snapshot.emcal = BuildMap(topNode, m_config.emcalNode, m_emMap);
+      snapshot.ihcal = BuildMap(topNode, m_config.ihcalNode, m_ihMap);
+      snapshot.ohcal = BuildMap(topNode, m_config.ohcalNode, m_ohMap);
+      return ApplyFilters(snapshot);
+    }
+
+    // ------------------------------------------------------------------------
+    //! Apply all filters to a snapshot of an event
+    // ------------------------------------------------------------------------
+    /*! Every stage is run (so that their QA stays complete), and the
+     *  decisions are OR'd together.
+     */
+    bool ApplyFilters(const bbfqd::TowerSnapshot& snapshot)
+    {
+      return ApplyStages(snapshot, std::index_sequence_for<Filters...>{});
+    }
+
+    ///! build histograms for all stages
+    void BuildHistograms(const std::string& module, const std::string& tag = "")
+    {
+      std::apply([&](auto&... filter) {(filter.BuildHistograms(module, tag), ...);}, m_filters);
+      return;
+    }
+
+    ///! add accumulated fills to histograms for all stages
+    void MergeHistograms()
+    {
+      std::apply([](auto&... filter) {(filter.MergeHistograms(), ...);}, m_filters);
+      return;
+    }
+
+    ///! register histograms for all stages
+    void RegisterHistograms(Fun4AllHistoManager* manager)
+    {
+      std::apply([&](auto&... filter) {(filter.RegisterHistograms(manager), ...);}, m_filters);
+      return;
+    }
+
+    ///! get decision of stage I from the last event
+    template <std::size_t I> bool GetDecision() const {return std::get<I>(m_decisions);}
+
+    ///! get stage I
+    template <std::size_t I> auto& GetFilter() {return std::get<I>(m_filters);}
+
+  private:
+
+    ///! run each stage, then combine decisions
+    template <std::size_t... I> bool ApplyStages(
+      const bbfqd::TowerSnapshot& snapshot,
+      std::index_sequence<I...> /*stages*/
+    ) {
+      ((std::get<I>(m_decisions) = std::get<I>(m_filters).ApplyFilterToSnapshot(snapshot)), ...);
+      return (std::get<I>(m_decisions) || ... || false);
+    }
+
+    ///! build a tower map if needed, and return a view of it
+    template <typename Map> bbfqd::TowerView BuildMap(
+      PHCompositeNode* topNode,
+      const std::string& node,
+      Map& map
+    ) {
+      if (node.empty()) return bbfqd::TowerView();
+
+      TowerInfoContainer* container = findNode::getClass<TowerInfoContainer>(topNode, node);
+      if (!container) return bbfqd::TowerView();
+
+      map.Reset();
+      map.Build(container);
+      return map.View();
+    }
+
+    ///! configuration
+    Config m_config;
+
+    ///! filters
+    std::tuple<Filters...> m_filters;
+
+    ///! decisions from last event
+    std::array<bool, NFilters> m_decisions;
+
+    ///! shared tower maps
+    bbfqd::EMCalMap m_emMap;
+    bbfqd::IHCalMap m_ihMap;
+    bbfqd::OHCalMap m_ohMap;
+
+};  // end FilterPipeline
+
+#endif
+
+// end ========================================================================
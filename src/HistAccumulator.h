@@ -0,0 +1,291 @@
+/// ===========================================================================
+/*! \file    HistAccumulator.h
+ *  \authors Derek Anderson
+ *  \date    10.16.2026
+ *
+ *  Part of the BeamBackgroundFilterAndQA module, this
+ *  collects histogram fills in per-thread buffers which
+ *  are merged into ROOT histograms afterwards.
+ */
+/// ===========================================================================
+
+#ifndef HISTACCUMULATOR_H
+#define HISTACCUMULATOR_H
+
+// c++ utilities
+#include <cassert>
+#include <cstdint>
+#include <vector>
+
+// root libraries
+#include <TH1.h>
+
+
+
+// ============================================================================
+//! Worker slot of the current thread
+// ============================================================================
+/*! Each thread filling accumulators should be assigned its own slot
+ *  (0, 1, 2, ...) via SetWorkerSlot before filling. Threads which
+ *  never set it (e.g. the main F4A thread) use slot 0.
+ */
+inline std::size_t& WorkerSlot()
+{
+  static thread_local std::size_t slot = 0;
+  return slot;
+}
+
+///! assign the current thread a worker slot
+inline void SetWorkerSlot(const std::size_t slot)
+{
+  WorkerSlot() = slot;
+}
+
+
+
+// ============================================================================
+//! Fixed-width binning of a 1D or 2D histogram
+// ============================================================================
+/*! A 1D histogram has nBinsY = 0.
+ */
+struct HistBinning
+{
+
+  // members
+  std::size_t nBinsX = 1;
+  double      xMin   = 0.;
+  double      xMax   = 1.;
+  std::size_t nBinsY = 0;
+  double      yMin   = 0.;
+  double      yMax   = 1.;
+
+  //! get no. of cells (incl. under-/overflow)
+  std::size_t GetNCells() const
+  {
+    return (nBinsX + 2) * ((nBinsY > 0) ? (nBinsY + 2) : 1);
+  }
+
+  //! get binning of a histogram
+  static HistBinning FromHist(TH1* hist)
+  {
+    HistBinning binning;
+    binning.nBinsX = hist->GetNbinsX();
+    binning.xMin   = hist->GetXaxis()->GetXmin();
+    binning.xMax   = hist->GetXaxis()->GetXmax();
+    if (hist->GetDimension() > 1)
+    {
+      binning.nBinsY = hist->GetNbinsY();
+      binning.yMin   = hist->GetYaxis()->GetXmin();
+      binning.yMax   = hist->GetYaxis()->GetXmax();
+    }
+    return binning;
+  }
+
+  //! check if two binnings are the same
+  bool operator==(const HistBinning& other) const
+  {
+    return (nBinsX == other.nBinsX) && (xMin == other.xMin) && (xMax == other.xMax) &&
+           (nBinsY == other.nBinsY) && (yMin == other.yMin) && (yMax == other.yMax);
+  }
+
+};  // end HistBinning
+
+
+
+// ============================================================================
+//! Per-thread histogram accumulator
+// ============================================================================
+/*! Mirrors the (fixed-width) binning of a 1D or 2D ROOT histogram, and
+ *  keeps a private set of bin contents for each worker slot. Slots are
+ *  separated by at least a cache line, so several threads can fill at
+ *  once without locks, atomics, or false sharing. The contents are
+ *  added to the histogram (and reset) by Merge(), e.g. at End or at a
+ *  checkpoint, which should only be called while no one is filling.
+ *  If there's no histogram, nothing is allocated and fills do nothing.
+ */
+template <typename T = double> class HistAccumulator
+{
+
+  public:
+
+    // ------------------------------------------------------------------------
+    //! ctor accepting histogram to merge into
+    // ------------------------------------------------------------------------
+    HistAccumulator(TH1* hist = nullptr, const std::size_t nSlots = 1)
+      : m_hist(hist)
+      , m_binning(hist ? HistBinning::FromHist(hist) : HistBinning())
+      , m_nSlots(nSlots > 0 ? nSlots : 1)
+    {
+      if (!m_hist) return;
+
+      // allocate slots: each holds all cells (incl. under-/overflow)
+      // plus a no. of entries, padded out by a cache line
+      m_nCells = m_binning.GetNCells();
+      m_stride = GetStride(m_binning);
+      m_counts.assign(m_stride * m_nSlots, 0);
+    }
+
+    ///! fill 1D
+    void Fill(const double x)
+    {
+      AddBinContent(FindBin(x));
+    }
+
+    ///! fill 2D
+    void Fill(const double x, const double y)
+    {
+      AddBinContent(FindBin(x, y));
+    }
+
+    ///! find (global) bin containing x
+    std::size_t FindBin(const double x) const
+    {
+      return FindBin(x, m_binning.nBinsX, m_binning.xMin, m_binning.xMax);
+    }
+
+    ///! find (global) bin containing (x, y)
+    std::size_t FindBin(const double x, const double y) const
+    {
+      return GetBin(
+        FindBin(x, m_binning.nBinsX, m_binning.xMin, m_binning.xMax),
+        FindBin(y, m_binning.nBinsY, m_binning.yMin, m_binning.yMax)
+      );
+    }
+
+    // ------------------------------------------------------------------------
+    //! Add to a (global) bin of current thread's slot
+    // ------------------------------------------------------------------------
+    void AddBinContent(const std::size_t bin, const T weight = 1)
+    {
+      if (m_counts.empty()) return;
+      assert(WorkerSlot() < m_nSlots);
+
+      T* slot = &m_counts[WorkerSlot() * m_stride];
+      slot[bin] += weight;
+      ++slot[m_nCells];
+      return;
+    }
+
+    // ------------------------------------------------------------------------
+    //! Make n unit-weight fills of a (global) bin of current thread's slot
+    // ------------------------------------------------------------------------
+    /*! Equivalent to n calls to Fill with a value in that bin, but skips
+     *  the bin lookup. Meant for counters indexed directly by e.g. a
+     *  tower's (eta, phi) bin.
+     */
+    void Increment(const std::size_t bin, const T n = 1)
+    {
+      if (m_counts.empty()) return;
+      assert(WorkerSlot() < m_nSlots);
+
+      T* slot = &m_counts[WorkerSlot() * m_stride];
+      slot[bin]      += n;
+      slot[m_nCells] += n;
+      return;
+    }
+
+    // ------------------------------------------------------------------------
+    //! Increment a list of (global) bins of current thread's slot
+    // ------------------------------------------------------------------------
+    /*! Bulk version of Increment: makes n unit-weight fills of each of
+     *  the nBins provided bins.
+     */
+    template <typename I> void IncrementN(const I* bins, const std::size_t nBins, const T n = 1)
+    {
+      if (m_counts.empty()) return;
+      assert(WorkerSlot() < m_nSlots);
+
+      T* slot = &m_counts[WorkerSlot() * m_stride];
+      for (std::size_t iBin = 0; iBin < nBins; ++iBin)
+      {
+        slot[bins[iBin]] += n;
+      }
+      slot[m_nCells] += n * nBins;
+      return;
+    }
+
+    ///! get global bin from x, y bin numbers
+    std::size_t GetBin(const std::size_t binX, const std::size_t binY = 0) const
+    {
+      return binX + ((m_binning.nBinsX + 2) * binY);
+    }
+
+    // ------------------------------------------------------------------------
+    //! Add accumulated contents to histogram
+    // ------------------------------------------------------------------------
+    /*! Reduces all slots into the histogram, then resets them.
+     */
+    void Merge()
+    {
+      if (!m_hist) return;
+
+      double nEntries = m_hist->GetEntries();
+      for (std::size_t iSlot = 0; iSlot < m_nSlots; ++iSlot)
+      {
+        T* slot = &m_counts[iSlot * m_stride];
+        for (std::size_t iCell = 0; iCell < m_nCells; ++iCell)
+        {
+          if (slot[iCell] == 0) continue;
+          m_hist->AddBinContent(iCell, slot[iCell]);
+          slot[iCell] = 0;
+        }
+        nEntries += slot[m_nCells];
+        slot[m_nCells] = 0;
+      }
+      m_hist->SetEntries(nEntries);
+      return;
+    }
+
+    ///! get histogram
+    TH1* GetHist() const {return m_hist;}
+
+    ///! check if accumulator is filling anything
+    bool IsEnabled() const {return !m_counts.empty();}
+
+    ///! get memory used by accumulated contents (in bytes)
+    std::size_t GetBytes() const {return m_counts.size() * sizeof(T);}
+
+    ///! get memory an accumulator w/ some binning and no. of slots would use (in bytes)
+    static std::size_t GetBytes(const HistBinning& binning, const std::size_t nSlots)
+    {
+      return GetStride(binning) * (nSlots > 0 ? nSlots : 1) * sizeof(T);
+    }
+
+  private:
+
+    ///! size of a cache line (in bytes)
+    static constexpr std::size_t CacheLine = 64;
+
+    ///! get no. of elements per slot: all cells, the no. of entries, and padding
+    static std::size_t GetStride(const HistBinning& binning)
+    {
+      return binning.GetNCells() + 1 + (CacheLine / sizeof(T));
+    }
+
+    ///! find bin along an axis, w/ ROOT conventions for under-/overflow
+    static std::size_t FindBin(const double value, const std::size_t nBins, const double min, const double max)
+    {
+      if (value < min)  return 0;
+      if (value >= max) return nBins + 1;
+      return 1 + static_cast<std::size_t>((value - min) * nBins / (max - min));
+    }
+
+    ///! histogram to merge into
+    TH1* m_hist;
+
+    ///! binning of histogram
+    HistBinning m_binning;
+
+    ///! slot layout
+    std::size_t m_nSlots = 1;
+    std::size_t m_nCells = 0;
+    std::size_t m_stride = 0;
+
+    ///! accumulated contents for all slots
+    std::vector<T> m_counts;
+
+};  // end HistAccumulator
+
+#endif
+
+// end ========================================================================
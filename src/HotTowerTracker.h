@@ -0,0 +1,191 @@
+/// ===========================================================================
+/*! \file    HotTowerTracker.h
+ *  \authors Derek Anderson
+ *  \date    10.16.2026
+ *
+ *  Part of the BeamBackgroundFilterAndQA module, this
+ *  learns which towers are hot over the course of a run
+ *  so that filters can mask them out.
+ */
+/// ===========================================================================
+
+#ifndef HOTTOWERTRACKER_H
+#define HOTTOWERTRACKER_H
+
+// c++ utilities
+#include <array>
+#include <cstdint>
+
+// module components
+#include "BeamBackgroundFilterAndQADefs.h"
+
+
+
+// ============================================================================
+//! Rolling hot-tower tracker
+// ============================================================================
+/*! Tracks how often each tower of an (eta, phi) map is above an energy
+ *  threshold, and masks towers which are above it in more than some
+ *  fraction of events. Hot towers which aren't (yet) flagged in the
+ *  calibrations would otherwise look like streak candidates.
+ *
+ *  To stay cheap, only every Nth event is looked at (sampleEvery), and
+ *  the mask is only recomputed when half a window of sampled events has
+ *  been collected. Occupancies are taken over the current and previous
+ *  half-windows, which approximates a rolling window without having to
+ *  keep per-event history.
+ *
+ *  The mask is stored as a bitmask indexed like the tower map, i.e. bit
+ *  (iEta * nPhi) + iPhi is set if that tower is hot.
+ */
+template <std::size_t H, std::size_t F> class HotTowerTracker
+{
+
+  public:
+
+    ///! map geometry
+    static constexpr std::size_t nEta    = H;
+    static constexpr std::size_t nPhi    = F;
+    static constexpr std::size_t nTowers = H * F;
+    static constexpr std::size_t nWords  = (nTowers + 63) / 64;
+
+    // ========================================================================
+    //! User options for tracker
+    // ========================================================================
+    struct Config
+    {
+      float    minEne       = 0.6;    ///! threshold for a tower to count as occupied
+      double   maxOccupancy = 0.05;   ///! occupancy above which a tower is hot
+      uint32_t window       = 2000;   ///! no. of sampled events in window
+      uint32_t sampleEvery  = 10;     ///! look at every Nth event
+    };
+
+    // ------------------------------------------------------------------------
+    //! ctor accepting config
+    // ------------------------------------------------------------------------
+    HotTowerTracker(const Config& config = Config())
+      : m_config(config)
+    {
+      Reset();
+    }
+
+    // ------------------------------------------------------------------------
+    //! Forget everything learned so far
+    // ------------------------------------------------------------------------
+    void Reset()
+    {
+      m_current.fill(0);
+      m_previous.fill(0);
+      m_mask.fill(0);
+      m_nCalls    = 0;
+      m_nCurrent  = 0;
+      m_nPrevious = 0;
+      m_nHot      = 0;
+    }
+
+    // ------------------------------------------------------------------------
+    //! Look at an event
+    // ------------------------------------------------------------------------
+    /*! Meant to be called every event: only every sampleEvery-th call
+     *  does any work. Views which don't fit the map are ignored.
+     */
+    void Observe(const BeamBackgroundFilterAndQADefs::TowerView& view)
+    {
+      const uint32_t sampleEvery = (m_config.sampleEvery > 0) ? m_config.sampleEvery : 1;
+      if ((m_nCalls++ % sampleEvery) != 0) return;
+      if (!view.IsValid() || (view.nEta > nEta) || (view.nPhi > nPhi)) return;
+
+      for (std::size_t iEta = 0; iEta < view.nEta; ++iEta)
+      {
+        for (std::size_t iPhi = 0; iPhi < view.nPhi; ++iPhi)
+        {
+          m_current[(iEta * nPhi) + iPhi] += (view.At(iEta, iPhi).energy > m_config.minEne);
+        }
+      }
+
+      // once half a window is collected, update mask and roll over
+      if (++m_nCurrent >= GetHalfWindow())
+      {
+        UpdateMask();
+      }
+    }
+
+    ///! check if a tower is hot
+    bool IsHot(const std::size_t iEta, const std::size_t iPhi) const
+    {
+      const std::size_t index = (iEta * nPhi) + iPhi;
+      return (m_mask[index / 64] >> (index % 64)) & 1;
+    }
+
+    ///! get mask of hot towers
+    const std::array<uint64_t, nWords>& GetMask() const {return m_mask;}
+
+    ///! get no. of towers currently masked
+    std::size_t GetNHot() const {return m_nHot;}
+
+    ///! get configuration
+    const Config& GetConfig() const {return m_config;}
+
+  private:
+
+    ///! get no. of sampled events in half a window
+    uint32_t GetHalfWindow() const
+    {
+      return (m_config.window > 1) ? (m_config.window / 2) : 1;
+    }
+
+    // ------------------------------------------------------------------------
+    //! Recompute mask from current + previous half-windows
+    // ------------------------------------------------------------------------
+    void UpdateMask()
+    {
+      const double nEvts = m_nCurrent + m_nPrevious;
+      const double nMax  = m_config.maxOccupancy * nEvts;
+
+      m_mask.fill(0);
+      m_nHot = 0;
+      for (std::size_t iTower = 0; iTower < nTowers; ++iTower)
+      {
+        const bool isHot = ((m_current[iTower] + m_previous[iTower]) > nMax);
+        m_mask[iTower / 64] |= (static_cast<uint64_t>(isHot) << (iTower % 64));
+        m_nHot += isHot;
+      }
+
+      // roll over to next half-window
+      m_previous  = m_current;
+      m_nPrevious = m_nCurrent;
+      m_current.fill(0);
+      m_nCurrent = 0;
+    }
+
+    ///! configuration
+    Config m_config;
+
+    ///! no. of times each tower was occupied in the
+    ///! current and previous half-windows
+    std::array<uint32_t, nTowers> m_current;
+    std::array<uint32_t, nTowers> m_previous;
+
+    ///! no. of calls and sampled events
+    uint64_t m_nCalls;
+    uint32_t m_nCurrent;
+    uint32_t m_nPrevious;
+
+    ///! current mask and no. of hot towers
+    std::array<uint64_t, nWords> m_mask;
+    std::size_t                  m_nHot;
+
+};  // end HotTowerTracker
+
+
+
+// ============================================================================
+//! Convenient aliases for the calorimeters
+// ============================================================================
+typedef HotTowerTracker<BeamBackgroundFilterAndQADefs::EMCalMap::nEta, BeamBackgroundFilterAndQADefs::EMCalMap::nPhi> EMCalHotTowerTracker;
+typedef HotTowerTracker<BeamBackgroundFilterAndQADefs::IHCalMap::nEta, BeamBackgroundFilterAndQADefs::IHCalMap::nPhi> IHCalHotTowerTracker;
+typedef HotTowerTracker<BeamBackgroundFilterAndQADefs::OHCalMap::nEta, BeamBackgroundFilterAndQADefs::OHCalMap::nPhi> OHCalHotTowerTracker;
+
+#endif
+
+// end ========================================================================
@@ -0,0 +1,360 @@
+/// ===========================================================================
+/*! \file    MergeQASidecars.cc
+ *  \authors Derek Anderson
+ *  \date    10.16.2026
+ *
+ *  Merges the QA sidecars written by many jobs of the
+ *  BeamBackgroundFilterAndQA module into a single ROOT
+ *  file of QA histograms.
+ *
+ *  Usage:
+ *    mergeqasidecars [-j <no. of threads>] <output.root> <inputs...>
+ *
+ *  where an input starting with '@' is a text file listing
+ *  sidecars, one per line.
+ */
+/// ===========================================================================
+
+// c++ utilities
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// system utilities
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// root libraries
+#include <TFile.h>
+#include <TH1.h>
+
+// module components
+#include "QASidecar.h"
+
+
+
+namespace
+{
+
+  // ==========================================================================
+  //! Running sums of all histograms
+  // ==========================================================================
+  /*! Integer-storage histograms are summed as integers, so no precision
+   *  is lost no matter how many sidecars are merged.
+   */
+  struct Totals
+  {
+    std::vector<std::vector<int64_t>> ints;
+    std::vector<std::vector<double>>  reals;
+    std::vector<double>               nEntries;
+
+    ///! size sums to match a layout
+    void Init(const std::vector<QASidecar::Entry>& layout)
+    {
+      ints.assign(layout.size(), {});
+      reals.assign(layout.size(), {});
+      nEntries.assign(layout.size(), 0.);
+      for (std::size_t iHist = 0; iHist < layout.size(); ++iHist)
+      {
+        const std::size_t nCells = layout[iHist].binning.GetNCells();
+        if (layout[iHist].isInteger)
+        {
+          ints[iHist].assign(nCells, 0);
+        }
+        else
+        {
+          reals[iHist].assign(nCells, 0.);
+        }
+      }
+    }
+
+    ///! add a parsed sidecar
+    void Add(const std::vector<QASidecar::Entry>& entries)
+    {
+      for (std::size_t iHist = 0; iHist < entries.size(); ++iHist)
+      {
+        const char* contents = entries[iHist].contents;
+        if (entries[iHist].isInteger)
+        {
+          for (std::size_t iCell = 0; iCell < ints[iHist].size(); ++iCell)
+          {
+            int64_t value = 0;
+            std::memcpy(&value, contents + (iCell * sizeof(int64_t)), sizeof(int64_t));
+            ints[iHist][iCell] += value;
+          }
+        }
+        else
+        {
+          for (std::size_t iCell = 0; iCell < reals[iHist].size(); ++iCell)
+          {
+            double value = 0.;
+            std::memcpy(&value, contents + (iCell * sizeof(double)), sizeof(double));
+            reals[iHist][iCell] += value;
+          }
+        }
+        nEntries[iHist] += entries[iHist].nEntries;
+      }
+    }
+
+    ///! add another set of sums
+    void Add(const Totals& other)
+    {
+      for (std::size_t iHist = 0; iHist < nEntries.size(); ++iHist)
+      {
+        for (std::size_t iCell = 0; iCell < ints[iHist].size(); ++iCell)
+        {
+          ints[iHist][iCell] += other.ints[iHist][iCell];
+        }
+        for (std::size_t iCell = 0; iCell < reals[iHist].size(); ++iCell)
+        {
+          reals[iHist][iCell] += other.reals[iHist][iCell];
+        }
+        nEntries[iHist] += other.nEntries[iHist];
+      }
+    }
+  };
+
+
+
+  // ==========================================================================
+  //! Read-only memory map of a file
+  // ==========================================================================
+  class MappedFile
+  {
+
+    public:
+
+      MappedFile(const std::string& path)
+      {
+        const int fd = open(path.data(), O_RDONLY);
+        if (fd < 0) return;
+
+        struct stat info;
+        if ((fstat(fd, &info) == 0) && (info.st_size > 0))
+        {
+          void* data = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+          if (data != MAP_FAILED)
+          {
+            m_data = static_cast<const char*>(data);
+            m_size = info.st_size;
+          }
+        }
+        close(fd);
+      }
+
+      ~MappedFile()
+      {
+        if (m_data)
+        {
+          munmap(const_cast<char*>(m_data), m_size);
+        }
+      }
+
+      const char* GetData() const {return m_data;}
+      std::size_t GetSize() const {return m_size;}
+
+    private:
+
+      const char* m_data = nullptr;
+      std::size_t m_size = 0;
+
+  };  // end MappedFile
+
+
+
+  // --------------------------------------------------------------------------
+  //! Collect input files, expanding '@' lists
+  // --------------------------------------------------------------------------
+  void AddInput(const std::string& arg, std::vector<std::string>& inputs)
+  {
+    if (arg.front() != '@')
+    {
+      inputs.push_back(arg);
+      return;
+    }
+
+    std::ifstream list(arg.substr(1));
+    if (!list)
+    {
+      std::cerr << "WARNING: couldn't open list " << arg.substr(1) << std::endl;
+      return;
+    }
+    for (std::string line; std::getline(list, line);)
+    {
+      if (!line.empty()) inputs.push_back(line);
+    }
+  }
+
+}  // end anonymous namespace
+
+
+
+// ============================================================================
+//! Merge QA sidecars
+// ============================================================================
+int main(int argc, char* argv[])
+{
+
+  // parse arguments
+  std::size_t              nThreads = std::max(1u, std::thread::hardware_concurrency());
+  std::string              output;
+  std::vector<std::string> inputs;
+  for (int iArg = 1; iArg < argc; ++iArg)
+  {
+    const std::string arg = argv[iArg];
+    if ((arg == "-j") && (iArg + 1 < argc))
+    {
+      nThreads = std::max(1, std::atoi(argv[++iArg]));
+    }
+    else if (output.empty())
+    {
+      output = arg;
+    }
+    else
+    {
+      AddInput(arg, inputs);
+    }
+  }
+  if (output.empty() || inputs.empty())
+  {
+    std::cerr << "Usage: " << argv[0] << " [-j <no. of threads>] <output.root> <inputs...>" << std::endl;
+    return 1;
+  }
+  nThreads = std::min(nThreads, inputs.size());
+
+  // take layout from first readable sidecar
+  std::vector<QASidecar::Entry> layout;
+  std::size_t iFirst = 0;
+  for (; iFirst < inputs.size(); ++iFirst)
+  {
+    MappedFile file(inputs[iFirst]);
+    if (file.GetData() && QASidecar::Parse(file.GetData(), file.GetSize(), layout))
+    {
+      for (auto& entry : layout)
+      {
+        entry.contents = nullptr;
+      }
+      break;
+    }
+    std::cerr << "WARNING: skipping unreadable sidecar " << inputs[iFirst] << std::endl;
+  }
+  if (iFirst == inputs.size())
+  {
+    std::cerr << "PANIC! No readable sidecars!" << std::endl;
+    return 1;
+  }
+
+  // merge sidecars in parallel: each thread maps files one
+  // at a time and keeps its own sums
+  std::vector<Totals> totals(nThreads);
+  std::atomic<std::size_t> iNext(iFirst);
+  std::atomic<std::size_t> nMerged(0);
+  std::mutex               warnMutex;
+
+  auto worker = [&](const std::size_t iThread)
+  {
+    Totals& sums = totals[iThread];
+    sums.Init(layout);
+
+    std::vector<QASidecar::Entry> entries;
+    for (std::size_t iInput = iNext++; iInput < inputs.size(); iInput = iNext++)
+    {
+      MappedFile file(inputs[iInput]);
+      const bool isGood = file.GetData() &&
+                          QASidecar::Parse(file.GetData(), file.GetSize(), entries) &&
+                          (entries.size() == layout.size()) &&
+                          std::equal(entries.begin(), entries.end(), layout.begin(),
+                                     [](const auto& a, const auto& b) {return a.IsCompatible(b);});
+      if (!isGood)
+      {
+        std::lock_guard<std::mutex> lock(warnMutex);
+        std::cerr << "WARNING: skipping unreadable or incompatible sidecar " << inputs[iInput] << std::endl;
+        continue;
+      }
+      sums.Add(entries);
+      ++nMerged;
+    }
+  };
+
+  std::vector<std::thread> threads;
+  for (std::size_t iThread = 0; iThread < nThreads; ++iThread)
+  {
+    threads.emplace_back(worker, iThread);
+  }
+  for (auto& thread : threads)
+  {
+    thread.join();
+  }
+
+  // combine threads
+  for (std::size_t iThread = 1; iThread < nThreads; ++iThread)
+  {
+    totals[0].Add(totals[iThread]);
+  }
+
+  // and write out histograms
+  //   - n.b. integer sums go into double-storage histograms,
+  //     since they can outgrow the 32 bits of a TH1I (doubles
+  //     hold them exactly up to 2^53)
+  constexpr int64_t maxExact = int64_t(1) << std::numeric_limits<double>::digits;
+
+  TFile* file = new TFile(output.data(), "recreate");
+  if (file->IsZombie() || !file->IsOpen())
+  {
+    std::cerr << "PANIC! Couldn't open output file " << output << "!" << std::endl;
+    delete file;
+    return 1;
+  }
+  file->cd();
+
+  bool isWritten = true;
+  for (std::size_t iHist = 0; iHist < layout.size(); ++iHist)
+  {
+    TH1* hist = QASidecar::MakeHist(layout[iHist], true);
+    bool isExact = true;
+    for (std::size_t iCell = 0; iCell < layout[iHist].binning.GetNCells(); ++iCell)
+    {
+      if (layout[iHist].isInteger)
+      {
+        const int64_t sum = totals[0].ints[iHist][iCell];
+        isExact = isExact && (sum <= maxExact) && (sum >= -maxExact);
+        hist->SetBinContent(iCell, static_cast<double>(sum));
+      }
+      else
+      {
+        hist->SetBinContent(iCell, totals[0].reals[iHist][iCell]);
+      }
+    }
+    if (!isExact)
+    {
+      std::cerr << "WARNING: sums of " << layout[iHist].name << " exceed 2^53 and were rounded" << std::endl;
+    }
+    hist->SetEntries(totals[0].nEntries[iHist]);
+    isWritten = (hist->Write() > 0) && isWritten;
+  }
+  file->Close();
+  delete file;
+
+  if (!isWritten)
+  {
+    std::cerr << "PANIC! Couldn't write histograms to " << output << "!" << std::endl;
+    return 1;
+  }
+
+  std::cout << "Merged " << nMerged << " of " << inputs.size() << " sidecars into " << output << std::endl;
+  return (nMerged == inputs.size()) ? 0 : 2;
+
+}
+
+// end ========================================================================
@@ -13,18 +13,36 @@
 
 // c++ utiilites
 #include <iostream>
+#include <memory>
 
 // phool libraries
 #include <phool/PHCompositeNode.h>
 
-// root libraries
-#include <TH1.h>
-
 // module components
 #include "NullFilter.h"
 
 
 
+// filter registration ========================================================
+
+namespace
+{
+
+  // --------------------------------------------------------------------------
+  //! Register filter with the filter factory
+  // --------------------------------------------------------------------------
+  [[maybe_unused]] const bool registered = BaseBeamBackgroundFilter::RegisterFilter(
+    "Null",
+    [](const std::string& name, const bbfqd::Parameters& params)
+    {
+      return std::make_unique<NullFilter>(NullFilter::ReadConfig(params), name);
+    }
+  );
+
+}  // end anonymous namespace
+
+
+
 // ctor/dtor ==================================================================
 
 // ----------------------------------------------------------------------------
@@ -47,6 +65,7 @@ NullFilter::NullFilter(const Config& config, const std::string& name)
 {
 
   m_name = name;
+  SetLogLevel((m_config.debug && (m_config.verbosity > 2)) ? bbfql::Trace : bbfql::Warn);
 
 }  // end ctor(Config&)
 
@@ -66,17 +85,35 @@ NullFilter::~NullFilter()
 
 // public methods =============================================================
 
+// ----------------------------------------------------------------------------
+//! Create config from parameter block
+// ----------------------------------------------------------------------------
+/*! Any options not in the block keep their default values. Keys which
+ *  aren't options of the filter are fatal.
+ */
+NullFilter::Config NullFilter::ReadConfig(const bbfqd::Parameters& params)
+{
+
+  bbfqd::CheckParameters(params, {"verbosity", "debug"}, "NullFilter");
+
+  Config config;
+  bbfqd::ReadParameter(params, "verbosity", config.verbosity);
+  bbfqd::ReadParameter(params, "debug", config.debug);
+  return config;
+
+}  // end 'ReadConfig(bbfqd::Parameters&)'
+
+
+
+
 // ----------------------------------------------------------------------------
 // Apply filter to check for beam background or not
 // ----------------------------------------------------------------------------
 bool NullFilter::ApplyFilter(PHCompositeNode* topNode)
 {
 
-  // print debug message
-  if (m_config.debug && (m_config.verbosity > 2))
-  {
-    std::cout << "NullFilter::ApplyFilter() Checking if streak found in OHCal via their sidebands" << std::endl;
-  }
+  // log debug message
+  Log<bbfql::Trace>("NullFilter::ApplyFilter() Checking if streak found in OHCal via their sidebands");
 
   // grab input node(s)
   GrabNodes(topNode);
@@ -84,7 +121,12 @@ bool NullFilter::ApplyFilter(PHCompositeNode* topNode)
   //... actual filter algorithm goes here ...//
 
   // other histograms filled similarly
-  m_hists["test"]->Fill(1);
+  //   - n.b. detailed qa should only be
+  //     filled when m_fillQA is true
+  if (m_fillQA)
+  {
+    GetAccumulator(Hist::Test).Fill(1);
+  }
 
   // should return
   //   true,  if found beam background
@@ -96,21 +138,47 @@ bool NullFilter::ApplyFilter(PHCompositeNode* topNode)
 
 
 // ----------------------------------------------------------------------------
-//! Construct histograms
+// Apply filter to a snapshot of an event
 // ----------------------------------------------------------------------------
-void NullFilter::BuildHistograms(const std::string& module, const std::string& tag)
+bool NullFilter::ApplyFilterToSnapshot(const bbfqd::TowerSnapshot& /*snapshot*/)
 {
 
-  // print debug message
-  if (m_config.debug && (m_config.verbosity > 2))
+  // log debug message
+  Log<bbfql::Trace>("NullFilter::ApplyFilterToSnapshot() Checking snapshot for beam background");
+
+  //... actual filter algorithm goes here ...//
+
+  // other histograms filled similarly
+  //   - n.b. detailed qa should only be
+  //     filled when m_fillQA is true
+  if (m_fillQA)
   {
-    std::cout << "NullFilter::BuildHistograms(std::string) Constructing histograms" << std::endl;
+    GetAccumulator(Hist::Test).Fill(1);
   }
 
+  // should return
+  //   true,  if found beam background
+  //   false, if no beam background found
+  return false;
+
+}  // end 'ApplyFilterToSnapshot(bbfqd::TowerSnapshot&)'
+
+
+
+// ----------------------------------------------------------------------------
+//! Construct histograms
+// ----------------------------------------------------------------------------
+void NullFilter::BuildHistograms(const std::string& module, const std::string& tag)
+{
+
+  // log debug message
+  Log<bbfql::Info>("NullFilter::BuildHistograms(std::string) Constructing histograms");
+
   // make sure module name is lower case
   std::string moduleAndFilterName = module + "_" + m_name;
 
   // names of variables to be histogramed
+  //   - n.b. order should match Hist enum
   const std::vector<std::string> varNames = {
     "test"
     //... variable names like NStreakTwr should go here ...//
@@ -120,7 +188,10 @@ void NullFilter::BuildHistograms(const std::string& module, const std::string& t
   std::vector<std::string> histNames = bbfqd::MakeQAHistNames(varNames, moduleAndFilterName, tag);
 
   // construct histograms
-  m_hists[varNames[0]] = new TH1D(histNames[0].data(), "", 2, -0.5, 1.5);
+  BuildHistogram(varNames[0], histNames[0], {2, -0.5, 1.5});
+
+  // and create accumulators to fill them
+  BuildAccumulators(varNames);
   return;
 
 }  // end 'BuildHistograms(std::string&, std::string&)'
@@ -135,11 +206,8 @@ void NullFilter::BuildHistograms(const std::string& module, const std::string& t
 void NullFilter::GrabNodes(PHCompositeNode* /*topNode*/)
 {
 
-  // print debug message
-  if (m_config.debug && (m_config.verbosity > 2))
-  {
-    std::cout << "NullFilter::GrabNodes(PHCompositeNode*) Grabbing input nodes" << std::endl;
-  }
+  // log debug message
+  Log<bbfql::Info>("NullFilter::GrabNodes(PHCompositeNode*) Grabbing input nodes");
 
   //... grab input nodes off the node tree here ...//
   return;
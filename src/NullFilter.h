@@ -19,12 +19,14 @@
 // module components
 #include "BaseBeamBackgroundFilter.h"
 #include "BeamBackgroundFilterAndQADefs.h"
+#include "BeamBackgroundFilterAndQALog.h"
 
 // forward declarations
 class PHCompositeNode;
 
-// alias for convenience
+// aliases for convenience
 namespace bbfqd = BeamBackgroundFilterAndQADefs;
+namespace bbfql = BeamBackgroundFilterAndQALog;
 
 
 
@@ -34,7 +36,7 @@ namespace bbfqd = BeamBackgroundFilterAndQADefs;
 /*! A beam background filter which does nothing, but
  *  provides a template for other filters.
  */
-class NullFilter : public BaseBeamBackgroundFilter
+class NullFilter final : public BaseBeamBackgroundFilter
 {
 
   public:
@@ -45,17 +47,28 @@ class NullFilter : public BaseBeamBackgroundFilter
     struct Config
     {
       int  verbosity = 0;
-      bool debug     = true;
+      bool debug     = false;
       //... additional options go here ...//
     };
 
+    // ========================================================================
+    //! Histogram handles
+    // ========================================================================
+    /*! Should follow the order of variables in BuildHistograms.
+     */
+    enum Hist {Test};
+
     // ctor/dtor
     NullFilter(const std::string& name = "Null");
     NullFilter(const Config& cfg, const std::string& name = "Null");
     ~NullFilter();
 
+    // create config from parameter block
+    static Config ReadConfig(const bbfqd::Parameters& params);
+
     // inherited methods
     bool ApplyFilter(PHCompositeNode* topNode) override;
+    bool ApplyFilterToSnapshot(const bbfqd::TowerSnapshot& /*snapshot*/) override;
     void BuildHistograms(const std::string& module, const std::string& tag = "") override;
 
   private:
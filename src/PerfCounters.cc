@@ -0,0 +1,255 @@
+/// ===========================================================================
+/*! \file    PerfCounters.cc
+ *  \authors Derek Anderson
+ *  \date    10.16.2026
+ *
+ *  Part of the BeamBackgroundFilterAndQA module, this
+ *  reads hardware performance counters (via Linux's
+ *  perf_event_open) around filters and their stages.
+ */
+/// ===========================================================================
+
+#define PERFCOUNTERS_CC
+
+// c++ utiilites
+#include <cstring>
+#include <iomanip>
+#include <sstream>
+
+// system utilities
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+// module components
+#include "PerfCounters.h"
+
+
+
+// ctor/dtor ==================================================================
+
+// ----------------------------------------------------------------------------
+//! Default ctor
+// ----------------------------------------------------------------------------
+PerfCounters::PerfCounters()
+  : m_leader(-1)
+  , m_nOpen(0)
+{
+
+  m_fds.fill(-1);
+  m_position.fill(-1);
+
+}  // end ctor()
+
+
+
+// ----------------------------------------------------------------------------
+//! Default dtor
+// ----------------------------------------------------------------------------
+PerfCounters::~PerfCounters()
+{
+
+  Close();
+
+}  // end dtor
+
+
+
+// public methods =============================================================
+
+// ----------------------------------------------------------------------------
+//! Open counters
+// ----------------------------------------------------------------------------
+/*! Returns false if no counters could be opened.
+ */
+bool PerfCounters::Open()
+{
+
+  Close();
+
+#ifdef __linux__
+  const std::array<uint64_t, NCounters> configs = {
+    PERF_COUNT_HW_CPU_CYCLES,
+    PERF_COUNT_HW_INSTRUCTIONS,
+    PERF_COUNT_HW_CACHE_MISSES,
+    PERF_COUNT_HW_BRANCH_MISSES
+  };
+
+  for (std::size_t iCounter = 0; iCounter < NCounters; ++iCounter)
+  {
+    perf_event_attr attr;
+    std::memset(&attr, 0, sizeof(attr));
+    attr.size           = sizeof(attr);
+    attr.type           = PERF_TYPE_HARDWARE;
+    attr.config         = configs[iCounter];
+    attr.disabled       = (m_leader < 0) ? 1 : 0;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv     = 1;
+    attr.read_format    = PERF_FORMAT_GROUP;
+
+    // first counter which opens leads the group
+    const int fd = syscall(SYS_perf_event_open, &attr, 0, -1, m_leader, 0);
+    if (fd < 0) continue;
+
+    if (m_leader < 0) m_leader = fd;
+    m_fds[iCounter]      = fd;
+    m_position[iCounter] = m_nOpen++;
+  }
+
+  // start counting
+  if (m_leader >= 0)
+  {
+    ioctl(m_leader, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    ioctl(m_leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+  }
+#endif
+  return IsOpen();
+
+}  // end 'Open()'
+
+
+
+// ----------------------------------------------------------------------------
+//! Close counters
+// ----------------------------------------------------------------------------
+void PerfCounters::Close()
+{
+
+#ifdef __linux__
+  for (int& fd : m_fds)
+  {
+    if (fd >= 0) close(fd);
+    fd = -1;
+  }
+#endif
+  m_leader = -1;
+  m_nOpen  = 0;
+  m_position.fill(-1);
+  return;
+
+}  // end 'Close()'
+
+
+
+// ----------------------------------------------------------------------------
+//! Start a measurement
+// ----------------------------------------------------------------------------
+PerfCounters::Sample PerfCounters::Begin() const
+{
+
+  return Read();
+
+}  // end 'Begin()'
+
+
+
+// ----------------------------------------------------------------------------
+//! End a measurement, adding it to some counts
+// ----------------------------------------------------------------------------
+void PerfCounters::End(const Sample& begin, Counts& counts) const
+{
+
+  if (!IsOpen()) return;
+
+  // skip measurements w/ a failed read, which
+  // would otherwise underflow the sums
+  const Sample end = Read();
+  if (!begin.isValid || !end.isValid)
+  {
+    ++counts.nFailed;
+    return;
+  }
+
+  for (std::size_t iCounter = 0; iCounter < NCounters; ++iCounter)
+  {
+    counts.values[iCounter] += end.values[iCounter] - begin.values[iCounter];
+  }
+  ++counts.nCalls;
+  return;
+
+}  // end 'End(Sample&, Counts&)'
+
+
+
+// ----------------------------------------------------------------------------
+//! Print per-call averages of some counts
+// ----------------------------------------------------------------------------
+/*! Formats into a local stream, so the formatting of out is untouched.
+ */
+void PerfCounters::Print(const std::string& label, const Counts& counts, std::ostream& out) const
+{
+
+  const std::array<std::string, NCounters> names = {"cycles", "instr.", "cache miss.", "branch miss."};
+
+  std::ostringstream line;
+  line << "    " << label << " (n = " << counts.nCalls;
+  if (counts.nFailed > 0)
+  {
+    line << ", " << counts.nFailed << " failed reads skipped";
+  }
+  line << "):";
+  for (std::size_t iCounter = 0; iCounter < NCounters; ++iCounter)
+  {
+    line << " " << names[iCounter] << " = ";
+    if ((m_position[iCounter] < 0) || (counts.nCalls == 0))
+    {
+      line << "n/a";
+    }
+    else
+    {
+      line << std::fixed << std::setprecision(1) << static_cast<double>(counts.values[iCounter]) / counts.nCalls;
+    }
+    line << ((iCounter + 1 < NCounters) ? "," : "");
+  }
+
+  // add instructions per cycle, if possible
+  const bool canGetIPC = (m_position[Cycles] >= 0) && (m_position[Instructions] >= 0) && (counts.values[Cycles] > 0);
+  if (canGetIPC)
+  {
+    line << ", IPC = " << std::setprecision(2) << static_cast<double>(counts.values[Instructions]) / counts.values[Cycles];
+  }
+  out << line.str() << std::endl;
+  return;
+
+}  // end 'Print(std::string&, Counts&, std::ostream&)'
+
+
+
+// private methods ============================================================
+
+// ----------------------------------------------------------------------------
+//! Read all counters at once
+// ----------------------------------------------------------------------------
+/*! Unavailable counters read as 0. The sample is only valid if the
+ *  group could be read.
+ */
+PerfCounters::Sample PerfCounters::Read() const
+{
+
+  Sample sample;
+#ifdef __linux__
+  if (m_leader < 0) return sample;
+
+  // group reads are laid out as the no. of
+  // counters followed by their values
+  std::array<uint64_t, NCounters + 1> buffer;
+  const ssize_t nRead = read(m_leader, buffer.data(), (m_nOpen + 1) * sizeof(uint64_t));
+  if (nRead < static_cast<ssize_t>((m_nOpen + 1) * sizeof(uint64_t))) return sample;
+
+  for (std::size_t iCounter = 0; iCounter < NCounters; ++iCounter)
+  {
+    if (m_position[iCounter] >= 0)
+    {
+      sample.values[iCounter] = buffer[1 + m_position[iCounter]];
+    }
+  }
+  sample.isValid = true;
+#endif
+  return sample;
+
+}  // end 'Read()'
+
+// end ========================================================================
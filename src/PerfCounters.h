@@ -0,0 +1,109 @@
+/// ===========================================================================
+/*! \file    PerfCounters.h
+ *  \authors Derek Anderson
+ *  \date    10.16.2026
+ *
+ *  Part of the BeamBackgroundFilterAndQA module, this
+ *  reads hardware performance counters (via Linux's
+ *  perf_event_open) around filters and their stages.
+ */
+/// ===========================================================================
+
+#ifndef PERFCOUNTERS_H
+#define PERFCOUNTERS_H
+
+// c++ utilities
+#include <array>
+#include <cstdint>
+#include <iostream>
+#include <string>
+
+
+
+// ============================================================================
+//! Hardware performance counters
+// ============================================================================
+/*! Counts cycles, instructions, cache misses, and branch misses of the
+ *  calling thread (in user space only), read together as one group. A
+ *  measurement is a pair of Begin/End calls, each of which is a single
+ *  read of the group, so measurements can be nested (e.g. a map build
+ *  inside a filter).
+ *
+ *  Counters are often unavailable (e.g. in VMs, containers, or when
+ *  perf_event_paranoid is too strict): Open() then returns false and
+ *  nothing is counted. Counters which are individually unsupported are
+ *  skipped and reported as n/a.
+ */
+class PerfCounters
+{
+
+  public:
+
+    ///! counters to read
+    enum Counter {Cycles, Instructions, CacheMisses, BranchMisses, NCounters};
+
+    // ========================================================================
+    //! Values of each counter at some point
+    // ========================================================================
+    /*! Not valid if the counters couldn't be read (or weren't, e.g. a
+     *  default-constructed sample).
+     */
+    struct Sample
+    {
+      std::array<uint64_t, NCounters> values  = {0, 0, 0, 0};
+      bool                            isValid = false;
+    };
+
+    // ========================================================================
+    //! Counts summed over many measurements
+    // ========================================================================
+    /*! Measurements where either read failed aren't summed, only counted
+     *  in nFailed.
+     */
+    struct Counts
+    {
+      std::array<uint64_t, NCounters> values  = {0, 0, 0, 0};
+      uint64_t                        nCalls  = 0;
+      uint64_t                        nFailed = 0;
+    };
+
+    // ctor/dtor
+    PerfCounters();
+    ~PerfCounters();
+
+    // no copying: this owns file descriptors
+    PerfCounters(const PerfCounters&) = delete;
+    PerfCounters& operator=(const PerfCounters&) = delete;
+
+    // open/close counters
+    bool Open();
+    void Close();
+
+    // measure
+    Sample Begin() const;
+    void   End(const Sample& begin, Counts& counts) const;
+
+    // report
+    void Print(const std::string& label, const Counts& counts, std::ostream& out = std::cout) const;
+
+    ///! check if any counters are being read
+    bool IsOpen() const {return m_leader >= 0;}
+
+  private:
+
+    // private methods
+    Sample Read() const;
+
+    ///! file descriptor of group leader, and of each counter (-1 if unavailable)
+    int                         m_leader;
+    std::array<int, NCounters>  m_fds;
+
+    ///! no. of counters in group, and position of each in a group read
+    std::size_t                 m_nOpen;
+    std::array<int, NCounters>  m_position;
+
+};  // end PerfCounters
+
+#endif
+
+// end ========================================================================
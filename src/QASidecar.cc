@@ -0,0 +1,314 @@
+/// ===========================================================================
+/*! \file    QASidecar.cc
+ *  \authors Derek Anderson
+ *  \date    10.16.2026
+ *
+ *  Part of the BeamBackgroundFilterAndQA module, this
+ *  defines a compact binary format for the module's QA
+ *  histograms, which can be merged quickly across jobs.
+ */
+/// ===========================================================================
+
+#define QASIDECAR_CC
+
+// c++ utiilites
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <limits>
+
+// root libraries
+#include <TH1.h>
+#include <TH2.h>
+
+// module components
+#include "QASidecar.h"
+
+
+
+namespace
+{
+
+  // --------------------------------------------------------------------------
+  //! Helpers to write plain values
+  // --------------------------------------------------------------------------
+  template <typename T> void Put(std::ofstream& out, const T value)
+  {
+    out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+  }
+
+  void PutString(std::ofstream& out, const std::string& value)
+  {
+    Put<uint32_t>(out, value.size());
+    out.write(value.data(), value.size());
+  }
+
+  // --------------------------------------------------------------------------
+  //! Bounds-checked reader over a buffer
+  // --------------------------------------------------------------------------
+  struct Cursor
+  {
+    const char* data;
+    std::size_t size;
+    std::size_t pos = 0;
+
+    ///! get no. of bytes left
+    std::size_t GetRemaining() const {return size - pos;}
+
+    template <typename T> bool Get(T& value)
+    {
+      if (sizeof(T) > GetRemaining()) return false;
+      std::memcpy(&value, data + pos, sizeof(T));
+      pos += sizeof(T);
+      return true;
+    }
+
+    bool GetString(std::string& value)
+    {
+      uint32_t length = 0;
+      if (!Get(length) || (length > GetRemaining())) return false;
+      value.assign(data + pos, length);
+      pos += length;
+      return true;
+    }
+
+    bool Skip(const std::size_t bytes)
+    {
+      if (bytes > GetRemaining()) return false;
+      pos += bytes;
+      return true;
+    }
+  };
+
+  // --------------------------------------------------------------------------
+  //! Smallest possible sizes of a histogram and a label in a sidecar
+  // --------------------------------------------------------------------------
+  /*! A histogram has at least its fixed fields, an empty name (and no
+   *  titles, as in version 1), and two cells (i.e. under- + overflow of
+   *  0 bins); a label has at least its bin and an empty string.
+   */
+  constexpr std::size_t MinHistBytes  = (2 * sizeof(uint32_t)) + sizeof(uint8_t) + (7 * sizeof(uint64_t)) + (2 * sizeof(int64_t));
+  constexpr std::size_t MinLabelBytes = 2 * sizeof(uint32_t);
+
+  // --------------------------------------------------------------------------
+  //! Get size of contents of a binning, checking for overflow
+  // --------------------------------------------------------------------------
+  /*! Returns false if the no. of bins doesn't fit a ROOT histogram, or if
+   *  the size in bytes doesn't fit a size_t.
+   */
+  bool GetContentBytes(const uint64_t nBinsX, const uint64_t nBinsY, std::size_t& bytes)
+  {
+    constexpr uint64_t maxBins = std::numeric_limits<int>::max() - 2;
+    if ((nBinsX > maxBins) || (nBinsY > maxBins)) return false;
+
+    const std::size_t nCellsX = nBinsX + 2;
+    const std::size_t nCellsY = (nBinsY > 0) ? (nBinsY + 2) : 1;
+    if (nCellsX > (std::numeric_limits<std::size_t>::max() / sizeof(int64_t)) / nCellsY) return false;
+
+    bytes = nCellsX * nCellsY * sizeof(int64_t);
+    return true;
+  }
+
+}  // end anonymous namespace
+
+
+
+// ----------------------------------------------------------------------------
+//! Write histograms to a sidecar file
+// ----------------------------------------------------------------------------
+/*! Only fixed-width 1D and 2D histograms are supported. Returns false
+ *  if the file couldn't be written.
+ */
+bool QASidecar::Write(const std::string& path, const std::vector<TH1*>& hists)
+{
+
+  std::ofstream out(path, std::ios::binary | std::ios::trunc);
+  if (!out)
+  {
+    std::cerr << "QASidecar::Write() WARNING: couldn't open " << path << std::endl;
+    return false;
+  }
+
+  // write header
+  Put<uint32_t>(out, Magic);
+  Put<uint32_t>(out, Version);
+  Put<uint32_t>(out, hists.size());
+
+  // write each histogram
+  for (TH1* hist : hists)
+  {
+    const bool        isInteger = dynamic_cast<TH1I*>(hist) || dynamic_cast<TH2I*>(hist);
+    const HistBinning binning   = HistBinning::FromHist(hist);
+
+    PutString(out, hist->GetName());
+    PutString(out, hist->GetTitle());
+    PutString(out, hist->GetXaxis()->GetTitle());
+    PutString(out, hist->GetYaxis()->GetTitle());
+    Put<uint8_t>(out, isInteger);
+    Put<uint64_t>(out, binning.nBinsX);
+    Put<double>(out, binning.xMin);
+    Put<double>(out, binning.xMax);
+    Put<uint64_t>(out, binning.nBinsY);
+    Put<double>(out, binning.yMin);
+    Put<double>(out, binning.yMax);
+    Put<double>(out, hist->GetEntries());
+
+    // write x-axis labels, if any
+    std::vector<std::pair<uint32_t, std::string>> labels;
+    if (hist->GetXaxis()->GetLabels())
+    {
+      for (std::size_t iBin = 1; iBin <= binning.nBinsX; ++iBin)
+      {
+        const std::string label = hist->GetXaxis()->GetBinLabel(iBin);
+        if (!label.empty())
+        {
+          labels.emplace_back(iBin, label);
+        }
+      }
+    }
+    Put<uint32_t>(out, labels.size());
+    for (const auto& label : labels)
+    {
+      Put<uint32_t>(out, label.first);
+      PutString(out, label.second);
+    }
+
+    // and write contents
+    for (std::size_t iCell = 0; iCell < binning.GetNCells(); ++iCell)
+    {
+      if (isInteger)
+      {
+        Put<int64_t>(out, static_cast<int64_t>(hist->GetBinContent(iCell)));
+      }
+      else
+      {
+        Put<double>(out, hist->GetBinContent(iCell));
+      }
+    }
+  }
+  return static_cast<bool>(out);
+
+}  // end 'Write(std::string&, std::vector<TH1*>&)'
+
+
+
+// ----------------------------------------------------------------------------
+//! Parse a sidecar from a buffer
+// ----------------------------------------------------------------------------
+/*! Contents aren't copied: the entries point into the buffer, which has
+ *  to outlive them. Returns false if the buffer isn't a valid sidecar.
+ */
+bool QASidecar::Parse(const char* data, const std::size_t size, std::vector<Entry>& entries)
+{
+
+  Cursor cursor {data, size};
+
+  // check header
+  uint32_t magic   = 0;
+  uint32_t version = 0;
+  uint32_t nHists  = 0;
+  if (!cursor.Get(magic) || !cursor.Get(version) || !cursor.Get(nHists)) return false;
+  if ((magic != Magic) || (version < 1) || (version > Version)) return false;
+
+  // read each histogram
+  //   - n.b. counts are checked against the bytes left
+  //     before allocating, so a corrupt count can't
+  //     trigger a huge allocation
+  if (nHists > cursor.GetRemaining() / MinHistBytes) return false;
+  entries.resize(nHists);
+  for (Entry& entry : entries)
+  {
+    uint8_t  isInteger = 0;
+    uint64_t nBinsX    = 0;
+    uint64_t nBinsY    = 0;
+    uint32_t nLabels   = 0;
+    if (!cursor.GetString(entry.name)) return false;
+    if ((version >= 2) &&
+        (!cursor.GetString(entry.title) || !cursor.GetString(entry.xTitle) || !cursor.GetString(entry.yTitle)))
+    {
+      return false;
+    }
+    if (!cursor.Get(isInteger) ||
+        !cursor.Get(nBinsX) ||
+        !cursor.Get(entry.binning.xMin) ||
+        !cursor.Get(entry.binning.xMax) ||
+        !cursor.Get(nBinsY) ||
+        !cursor.Get(entry.binning.yMin) ||
+        !cursor.Get(entry.binning.yMax) ||
+        !cursor.Get(entry.nEntries) ||
+        !cursor.Get(nLabels))
+    {
+      return false;
+    }
+    entry.isInteger      = isInteger;
+    entry.binning.nBinsX = nBinsX;
+    entry.binning.nBinsY = nBinsY;
+
+    if (nLabels > cursor.GetRemaining() / MinLabelBytes) return false;
+    entry.labels.resize(nLabels);
+    for (auto& label : entry.labels)
+    {
+      if (!cursor.Get(label.first) || !cursor.GetString(label.second)) return false;
+    }
+
+    // contents are 8 bytes per cell either way
+    std::size_t contentBytes = 0;
+    if (!GetContentBytes(nBinsX, nBinsY, contentBytes)) return false;
+    entry.contents = data + cursor.pos;
+    if (!cursor.Skip(contentBytes)) return false;
+  }
+  return true;
+
+}  // end 'Parse(char*, std::size_t, std::vector<Entry>&)'
+
+
+
+// ----------------------------------------------------------------------------
+//! Create an empty histogram matching an entry
+// ----------------------------------------------------------------------------
+/*! If asDouble is set, integer-storage histograms are created w/ double
+ *  storage instead (e.g. for sums over many jobs, which can overflow the
+ *  32 bits of a TH1I).
+ */
+TH1* QASidecar::MakeHist(const Entry& entry, const bool asDouble)
+{
+
+  const HistBinning& bins      = entry.binning;
+  const bool         isInteger = entry.isInteger && !asDouble;
+
+  TH1* hist = nullptr;
+  if (bins.nBinsY == 0)
+  {
+    if (isInteger)
+    {
+      hist = new TH1I(entry.name.data(), entry.title.data(), bins.nBinsX, bins.xMin, bins.xMax);
+    }
+    else
+    {
+      hist = new TH1D(entry.name.data(), entry.title.data(), bins.nBinsX, bins.xMin, bins.xMax);
+    }
+  }
+  else
+  {
+    if (isInteger)
+    {
+      hist = new TH2I(entry.name.data(), entry.title.data(), bins.nBinsX, bins.xMin, bins.xMax, bins.nBinsY, bins.yMin, bins.yMax);
+    }
+    else
+    {
+      hist = new TH2D(entry.name.data(), entry.title.data(), bins.nBinsX, bins.xMin, bins.xMax, bins.nBinsY, bins.yMin, bins.yMax);
+    }
+  }
+  hist->GetXaxis()->SetTitle(entry.xTitle.data());
+  hist->GetYaxis()->SetTitle(entry.yTitle.data());
+
+  for (const auto& label : entry.labels)
+  {
+    hist->GetXaxis()->SetBinLabel(label.first, label.second.data());
+  }
+  return hist;
+
+}  // end 'MakeHist(Entry&, bool)'
+
+// end ========================================================================
@@ -0,0 +1,94 @@
+/// ===========================================================================
+/*! \file    QASidecar.h
+ *  \authors Derek Anderson
+ *  \date    10.16.2026
+ *
+ *  Part of the BeamBackgroundFilterAndQA module, this
+ *  defines a compact binary format for the module's QA
+ *  histograms, which can be merged quickly across jobs.
+ */
+/// ===========================================================================
+
+#ifndef QASIDECAR_H
+#define QASIDECAR_H
+
+// c++ utilities
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+// module components
+#include "HistAccumulator.h"
+
+// forward declarations
+class TH1;
+
+
+
+// ============================================================================
+//! QA sidecar format
+// ============================================================================
+/*! A sidecar file holds the contents of a set of histograms, e.g. all of
+ *  the QA histograms of one job, laid out as (in native byte order):
+ *
+ *    header: magic (u32), version (u32), no. of histograms (u32)
+ *    for each histogram:
+ *      name length (u32) + name
+ *      title, x-axis title, and y-axis title, each as length (u32)
+ *        + title (since version 2)
+ *      storage (u8: 1 = integer, 0 = floating point)
+ *      binning: nBinsX (u64), xMin (f64), xMax (f64),
+ *               nBinsY (u64), yMin (f64), yMax (f64)
+ *      no. of entries (f64)
+ *      no. of x-axis bin labels (u32), each as bin (u32) +
+ *        label length (u32) + label
+ *      contents of all cells, incl. under-/overflow (i64 or f64)
+ *
+ *  Contents are stored as i64 for integer-storage histograms (TH1I/TH2I)
+ *  and as f64 otherwise. Since the names stored are the full histogram
+ *  names, merged sidecars reproduce the QA-compliant histograms exactly.
+ *  Version 1 sidecars (w/o titles) can still be read.
+ */
+namespace QASidecar
+{
+
+  ///! file identifiers
+  inline constexpr uint32_t Magic   = 0x51464242;  // "BBFQ"
+  inline constexpr uint32_t Version = 2;
+
+  // ==========================================================================
+  //! One histogram in a sidecar
+  // ==========================================================================
+  /*! When parsed from a buffer (e.g. a mapped file), the contents point
+   *  into that buffer rather than being copied, and may be unaligned.
+   */
+  struct Entry
+  {
+    std::string name;
+    std::string title;
+    std::string xTitle;
+    std::string yTitle;
+    bool        isInteger = true;
+    HistBinning binning;
+    double      nEntries  = 0.;
+    std::vector<std::pair<uint32_t, std::string>> labels;
+    const char* contents  = nullptr;
+
+    ///! check if another entry describes the same histogram
+    bool IsCompatible(const Entry& other) const
+    {
+      return (name == other.name) && (isInteger == other.isInteger) && (binning == other.binning);
+    }
+  };
+
+  // methods
+  bool Write(const std::string& path, const std::vector<TH1*>& hists);
+  bool Parse(const char* data, const std::size_t size, std::vector<Entry>& entries);
+  TH1* MakeHist(const Entry& entry, const bool asDouble = false);
+
+}  // end QASidecar namespace
+
+#endif
+
+// end ========================================================================
@@ -0,0 +1,199 @@
+/// ===========================================================================
+/*! \file    QASnapshotWriter.cc
+ *  \authors Derek Anderson
+ *  \date    10.16.2026
+ *
+ *  Part of the BeamBackgroundFilterAndQA module, this
+ *  periodically writes out the module's event counts
+ *  while a job is running.
+ */
+/// ===========================================================================
+
+#define QASNAPSHOTWRITER_CC
+
+// c++ utiilites
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <utility>
+
+// module components
+#include "QASnapshotWriter.h"
+
+
+
+// ctor/dtor ==================================================================
+
+// ----------------------------------------------------------------------------
+//! ctor accepting output file and prototype snapshot
+// ----------------------------------------------------------------------------
+/*! Starts the writer thread. The back buffers start out as copies of
+ *  the prototype, so that once the caller's snapshot is sized the same
+ *  way, refilling whichever buffer Publish hands back doesn't allocate.
+ */
+QASnapshotWriter::QASnapshotWriter(const std::string& path, const Snapshot& prototype)
+  : m_path(path)
+  , m_pending(prototype)
+  , m_writing(prototype)
+  , m_hasPending(false)
+  , m_stop(false)
+  , m_nDropped(0)
+  , m_nWritten(0)
+{
+
+  m_thread = std::thread(&QASnapshotWriter::Run, this);
+
+}  // end ctor(std::string&, Snapshot&)
+
+
+
+// ----------------------------------------------------------------------------
+//! Default dtor
+// ----------------------------------------------------------------------------
+/*! Stops the writer thread (after it finishes any pending snapshot).
+ */
+QASnapshotWriter::~QASnapshotWriter()
+{
+
+  Stop();
+
+}  // end dtor
+
+
+
+// public methods =============================================================
+
+// ----------------------------------------------------------------------------
+//! Hand a snapshot over to the writer
+// ----------------------------------------------------------------------------
+/*! Never blocks: if the writer is busy, the snapshot is dropped and false
+ *  is returned. Otherwise the snapshot is swapped into the back buffer,
+ *  so the caller gets an old buffer back (to be refilled) and nothing is
+ *  copied or allocated.
+ */
+bool QASnapshotWriter::Publish(Snapshot& snapshot)
+{
+
+  std::unique_lock<std::mutex> lock(m_mutex, std::try_to_lock);
+  if (!lock.owns_lock() || m_hasPending || m_stop)
+  {
+    ++m_nDropped;
+    return false;
+  }
+
+  std::swap(snapshot, m_pending);
+  m_hasPending = true;
+  lock.unlock();
+
+  m_wake.notify_one();
+  return true;
+
+}  // end 'Publish(Snapshot&)'
+
+
+
+// ----------------------------------------------------------------------------
+//! Write a final snapshot
+// ----------------------------------------------------------------------------
+/*! Stops the writer thread (after it finishes any pending snapshot) and
+ *  then writes the provided one, blocking until it's done. Meant for the
+ *  end of a job: nothing else can be published afterwards.
+ */
+void QASnapshotWriter::Finish(const Snapshot& snapshot)
+{
+
+  Stop();
+  Write(snapshot);
+  return;
+
+}  // end 'Finish(Snapshot&)'
+
+
+
+// private methods ============================================================
+
+// ----------------------------------------------------------------------------
+//! Writer loop
+// ----------------------------------------------------------------------------
+void QASnapshotWriter::Run()
+{
+
+  std::unique_lock<std::mutex> lock(m_mutex);
+  while (true)
+  {
+    m_wake.wait(lock, [this] {return m_hasPending || m_stop;});
+    if (!m_hasPending && m_stop) break;
+
+    // take pending snapshot, and write it out
+    // without holding the lock
+    std::swap(m_pending, m_writing);
+    m_hasPending = false;
+    lock.unlock();
+
+    Write(m_writing);
+    lock.lock();
+  }
+  return;
+
+}  // end 'Run()'
+
+
+
+// ----------------------------------------------------------------------------
+//! Stop writer thread
+// ----------------------------------------------------------------------------
+void QASnapshotWriter::Stop()
+{
+
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stop = true;
+  }
+  m_wake.notify_one();
+  if (m_thread.joinable())
+  {
+    m_thread.join();
+  }
+  return;
+
+}  // end 'Stop()'
+
+
+
+// ----------------------------------------------------------------------------
+//! Write a snapshot to file
+// ----------------------------------------------------------------------------
+void QASnapshotWriter::Write(const Snapshot& snapshot)
+{
+
+  // write to temporary file
+  const std::string tmpPath = m_path + ".tmp";
+  {
+    std::ofstream out(tmpPath, std::ios::trunc);
+    if (!out)
+    {
+      std::cerr << "QASnapshotWriter::Write() WARNING: couldn't open " << tmpPath << std::endl;
+      return;
+    }
+
+    out << "sequence " << ++m_nWritten << "\n"
+        << "elapsed " << snapshot.elapsed << "\n"
+        << "events " << snapshot.nEvents << "\n";
+    for (std::size_t iCount = 0; iCount < snapshot.counts.size(); ++iCount)
+    {
+      out << "counts " << snapshot.names[iCount];
+      for (const uint64_t count : snapshot.counts[iCount])
+      {
+        out << " " << count;
+      }
+      out << "\n";
+    }
+  }
+
+  // and move into place
+  std::rename(tmpPath.data(), m_path.data());
+  return;
+
+}  // end 'Write(Snapshot&)'
+
+// end ========================================================================
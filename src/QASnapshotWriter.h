@@ -0,0 +1,103 @@
+/// ===========================================================================
+/*! \file    QASnapshotWriter.h
+ *  \authors Derek Anderson
+ *  \date    10.16.2026
+ *
+ *  Part of the BeamBackgroundFilterAndQA module, this
+ *  periodically writes out the module's event counts
+ *  while a job is running.
+ */
+/// ===========================================================================
+
+#ifndef QASNAPSHOTWRITER_H
+#define QASNAPSHOTWRITER_H
+
+// c++ utilities
+#include <array>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+
+
+// ============================================================================
+//! Writes snapshots of QA counts in the background
+// ============================================================================
+/*! Snapshots are handed over with Publish(), which never blocks: the
+ *  snapshot is swapped into a back buffer and written out by a separate
+ *  thread. If the writer is still busy with the previous one, the new
+ *  snapshot is simply dropped. Files are written to a temporary file and
+ *  then renamed, so readers never see a partial snapshot. Pointing the
+ *  output at e.g. /dev/shm keeps everything in memory.
+ *
+ *  The format is plain text, one line per quantity:
+ *
+ *    sequence <no. of snapshots written>
+ *    elapsed <seconds since start>
+ *    events <no. of events>
+ *    counts <name> <all> <no bkgd.> <has bkgd.>
+ */
+class QASnapshotWriter
+{
+
+  public:
+
+    // ========================================================================
+    //! Snapshot of the module's counts
+    // ========================================================================
+    struct Snapshot
+    {
+      uint64_t nEvents = 0;
+      double   elapsed = 0.;
+
+      ///! names and (all, no bkgd., has bkgd.) counts
+      ///! of each counter (overall + each filter)
+      std::vector<std::string> names;
+      std::vector<std::array<uint64_t, 3>> counts;
+    };
+
+    // ctor/dtor
+    QASnapshotWriter(const std::string& path, const Snapshot& prototype);
+    ~QASnapshotWriter();
+
+    // publish snapshots
+    bool Publish(Snapshot& snapshot);
+    void Finish(const Snapshot& snapshot);
+
+    ///! get no. of snapshots dropped because writer was busy
+    uint64_t GetNDropped() const {return m_nDropped;}
+
+  private:
+
+    // private methods
+    void Run();
+    void Stop();
+    void Write(const Snapshot& snapshot);
+
+    ///! output file
+    std::string m_path;
+
+    ///! back buffer (handed over by Publish) and
+    ///! buffer being written
+    Snapshot m_pending;
+    Snapshot m_writing;
+
+    ///! writer state
+    bool     m_hasPending;
+    bool     m_stop;
+    uint64_t m_nDropped;
+    uint64_t m_nWritten;
+
+    ///! synchronization
+    std::mutex              m_mutex;
+    std::condition_variable m_wake;
+    std::thread             m_thread;
+
+};  // end QASnapshotWriter
+
+#endif
+
+// end ========================================================================
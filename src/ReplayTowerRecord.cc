@@ -0,0 +1,205 @@
+/// ===========================================================================
+/*! \file    ReplayTowerRecord.cc
+ *  \authors Derek Anderson
+ *  \date    10.16.2026
+ *
+ *  Replays a tower record (see TowerRecord.h, written by
+ *  the TowerRecorder module) through any registered beam
+ *  background filters, i.e. without Fun4All, DSTs, ROOT
+ *  I/O, or a node tree.
+ *
+ *  Usage:
+ *    replaytowerrecord [-f <filter type>]... [-p <filter>:<key>=<value>]...
+ *                      [-n <max. no. of events>] [-b <batch size>]
+ *                      [-o <list of flagged events>] <record>
+ *
+ *  If no filters are given, the streak sideband filter
+ *  is replayed. With -o, the run + event no. of every
+ *  event flagged by any filter is written out, followed
+ *  by the names of the filters which flagged it.
+ */
+/// ===========================================================================
+
+// c++ utilities
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+// module components
+#include "BaseBeamBackgroundFilter.h"
+#include "BeamBackgroundFilterAndQADefs.h"
+#include "TowerRecord.h"
+
+// alias for convenience
+namespace bbfqd = BeamBackgroundFilterAndQADefs;
+
+
+
+// ============================================================================
+//! Replay a record
+// ============================================================================
+int main(int argc, char* argv[])
+{
+
+  // parse arguments
+  std::vector<std::string>                 types;
+  std::map<std::string, bbfqd::Parameters> params;
+  uint64_t                                 maxEvents = 0;
+  std::size_t                              batchSize = 64;
+  std::string                              listFile  = "";
+  std::string                              input     = "";
+  for (int iArg = 1; iArg < argc; ++iArg)
+  {
+    const std::string arg = argv[iArg];
+    if ((arg == "-f") && (iArg + 1 < argc))
+    {
+      types.push_back(argv[++iArg]);
+    }
+    else if ((arg == "-p") && (iArg + 1 < argc))
+    {
+      // parameters look like <filter>:<key>=<value>
+      const std::string param  = argv[++iArg];
+      const std::size_t iColon = param.find(':');
+      const std::size_t iEqual = param.find('=', iColon);
+      if ((iColon == std::string::npos) || (iEqual == std::string::npos))
+      {
+        std::fprintf(stderr, "PANIC! Bad parameter '%s' (expected <filter>:<key>=<value>)\n", param.data());
+        return 1;
+      }
+      params[param.substr(0, iColon)][param.substr(iColon + 1, iEqual - iColon - 1)] = param.substr(iEqual + 1);
+    }
+    else if ((arg == "-n") && (iArg + 1 < argc))
+    {
+      maxEvents = std::strtoull(argv[++iArg], nullptr, 10);
+    }
+    else if ((arg == "-b") && (iArg + 1 < argc))
+    {
+      batchSize = std::max(std::atoi(argv[++iArg]), 1);
+    }
+    else if ((arg == "-o") && (iArg + 1 < argc))
+    {
+      listFile = argv[++iArg];
+    }
+    else
+    {
+      input = arg;
+    }
+  }
+  if (input.empty())
+  {
+    std::fprintf(stderr, "Usage: %s [-f <filter type>]... [-p <filter>:<key>=<value>]... [-n <max. events>] [-b <batch size>] [-o <flagged list>] <record>\n", argv[0]);
+    return 1;
+  }
+  if (types.empty())
+  {
+    types.push_back("StreakSideband");
+  }
+
+  // open record
+  TowerRecord::Reader reader;
+  if (!reader.Open(input))
+  {
+    std::fprintf(stderr, "PANIC! Couldn't read tower record '%s'\n", input.data());
+    return 1;
+  }
+  const uint64_t nEvents = (maxEvents > 0) ? std::min(maxEvents, reader.GetNEvents()) : reader.GetNEvents();
+
+  // create filters
+  std::vector<std::unique_ptr<BaseBeamBackgroundFilter>> filters;
+  for (const std::string& type : types)
+  {
+    filters.push_back(BaseBeamBackgroundFilter::CreateFilter(type, type, params[type]));
+    if (!filters.back())
+    {
+      std::fprintf(stderr, "PANIC! Unknown filter '%s'\n", type.data());
+      return 1;
+    }
+  }
+
+  std::ofstream list;
+  if (!listFile.empty())
+  {
+    list.open(listFile);
+  }
+
+  // replay in batches: decode a batch, then hand it to each filter
+  std::vector<TowerRecord::Event>   events(batchSize);
+  std::vector<bbfqd::TowerSnapshot> snapshots;
+  std::vector<std::vector<uint8_t>> decisions(filters.size(), std::vector<uint8_t>(batchSize));
+  std::vector<uint64_t>             nFlagged(filters.size(), 0);
+  std::vector<double>               filterTime(filters.size(), 0.);
+  double                            readTime = 0.;
+  uint64_t                          nRead    = 0;
+  while (nRead < nEvents)
+  {
+    const std::size_t nBatch = std::min<uint64_t>(batchSize, nEvents - nRead);
+
+    const auto readStart = std::chrono::steady_clock::now();
+    snapshots.resize(nBatch);
+    for (std::size_t iEvt = 0; iEvt < nBatch; ++iEvt)
+    {
+      if (!reader.Read(nRead + iEvt, events[iEvt]))
+      {
+        std::fprintf(stderr, "PANIC! Couldn't read event %llu\n", static_cast<unsigned long long>(nRead + iEvt));
+        return 1;
+      }
+      snapshots[iEvt] = events[iEvt].snapshot;
+    }
+    readTime += std::chrono::duration<double>(std::chrono::steady_clock::now() - readStart).count();
+
+    for (std::size_t iFilter = 0; iFilter < filters.size(); ++iFilter)
+    {
+      const auto filterStart = std::chrono::steady_clock::now();
+      filters[iFilter]->ApplyFilterToBatch(snapshots.data(), nBatch, decisions[iFilter].data());
+      filterTime[iFilter] += std::chrono::duration<double>(std::chrono::steady_clock::now() - filterStart).count();
+      nFlagged[iFilter]   += std::count(decisions[iFilter].begin(), decisions[iFilter].begin() + nBatch, 1);
+    }
+
+    // if needed, list flagged events
+    if (list.is_open())
+    {
+      for (std::size_t iEvt = 0; iEvt < nBatch; ++iEvt)
+      {
+        bool isFlagged = false;
+        for (std::size_t iFilter = 0; iFilter < filters.size(); ++iFilter)
+        {
+          if (!decisions[iFilter][iEvt]) continue;
+          if (!isFlagged)
+          {
+            list << events[iEvt].run << " " << events[iEvt].event;
+            isFlagged = true;
+          }
+          list << " " << types[iFilter];
+        }
+        if (isFlagged) list << "\n";
+      }
+    }
+    nRead += nBatch;
+  }
+
+  // summarize
+  std::printf("Replayed %llu events from %s (compression level %d)\n",
+              static_cast<unsigned long long>(nRead),
+              input.data(),
+              reader.GetLevel());
+  std::printf("  %-20s %12.1f ns/evt\n", "read + decode", (readTime * 1e9) / std::max<uint64_t>(nRead, 1));
+  for (std::size_t iFilter = 0; iFilter < filters.size(); ++iFilter)
+  {
+    std::printf("  %-20s %12.1f ns/evt, flagged %llu (%.4f%%)\n",
+                types[iFilter].data(),
+                (filterTime[iFilter] * 1e9) / std::max<uint64_t>(nRead, 1),
+                static_cast<unsigned long long>(nFlagged[iFilter]),
+                (100. * nFlagged[iFilter]) / std::max<uint64_t>(nRead, 1));
+  }
+  return 0;
+
+}
+
+// end ========================================================================
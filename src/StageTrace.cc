@@ -0,0 +1,182 @@
+/// ===========================================================================
+/*! \file    StageTrace.cc
+ *  \authors Derek Anderson
+ *  \date    10.16.2026
+ *
+ *  Part of the BeamBackgroundFilterAndQA module, this
+ *  records begin/end times of filters and their stages
+ *  for viewing on a timeline (as a Chrome trace).
+ */
+/// ===========================================================================
+
+#define STAGETRACE_CC
+
+// c++ utiilites
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <ostream>
+
+// module components
+#include "StageTrace.h"
+
+
+
+namespace
+{
+
+  // --------------------------------------------------------------------------
+  //! Write a string as the contents of a JSON string
+  // --------------------------------------------------------------------------
+  /*! Escapes quotes, backslashes, and control characters, since names
+   *  (e.g. of filters) come from user configuration.
+   */
+  void PutEscaped(std::ostream& out, const char* text)
+  {
+    for (const char* character = text; *character != '\0'; ++character)
+    {
+      const unsigned char code = static_cast<unsigned char>(*character);
+      switch (*character)
+      {
+        case '"':  out << "\\\""; break;
+        case '\\': out << "\\\\"; break;
+        case '\n': out << "\\n"; break;
+        case '\t': out << "\\t"; break;
+        case '\r': out << "\\r"; break;
+        default:
+          if (code < 0x20)
+          {
+            const char* digits = "0123456789abcdef";
+            out << "\\u00" << digits[code >> 4] << digits[code & 0xf];
+          }
+          else
+          {
+            out << *character;
+          }
+          break;
+      }
+    }
+  }
+
+}  // end anonymous namespace
+
+
+
+// public methods =============================================================
+
+// ----------------------------------------------------------------------------
+//! Allocate buffers and start the clock
+// ----------------------------------------------------------------------------
+/*! Each of the nSlots buffers holds up to capacity spans.
+ */
+void StageTrace::Open(const std::size_t nSlots, const std::size_t capacity)
+{
+
+  m_buffers = std::vector<Buffer>(std::max<std::size_t>(nSlots, 1));
+  for (Buffer& buffer : m_buffers)
+  {
+    buffer.spans.resize(capacity);
+  }
+  m_origin = std::chrono::steady_clock::now();
+  return;
+
+}  // end 'Open(std::size_t, std::size_t)'
+
+
+
+// ----------------------------------------------------------------------------
+//! Release buffers
+// ----------------------------------------------------------------------------
+void StageTrace::Close()
+{
+
+  m_buffers.clear();
+  m_buffers.shrink_to_fit();
+  return;
+
+}  // end 'Close()'
+
+
+
+// ----------------------------------------------------------------------------
+//! Write recorded spans as a Chrome trace
+// ----------------------------------------------------------------------------
+/*! Times are written in us (the unit of the format) w/ ns precision.
+ *  Each span carries the event no. it was recorded in as an argument.
+ */
+bool StageTrace::Write(const std::string& path) const
+{
+
+  std::ofstream out(path);
+  if (!out) return false;
+
+  out << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n";
+  out << std::fixed << std::setprecision(3);
+
+  // name a track for each slot
+  bool isFirst = true;
+  for (std::size_t iSlot = 0; iSlot < m_buffers.size(); ++iSlot)
+  {
+    out << (isFirst ? "" : ",\n")
+        << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << iSlot
+        << ",\"args\":{\"name\":\"worker " << iSlot << "\"}}";
+    isFirst = false;
+  }
+
+  // and write its spans
+  for (std::size_t iSlot = 0; iSlot < m_buffers.size(); ++iSlot)
+  {
+    const Buffer& buffer = m_buffers[iSlot];
+    for (std::size_t iSpan = 0; iSpan < buffer.nSpans; ++iSpan)
+    {
+      const Span& span = buffer.spans[iSpan];
+      out << ",\n{\"name\":\"";
+      PutEscaped(out, span.name);
+      out << "\",\"cat\":\"";
+      PutEscaped(out, span.category);
+      out << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << iSlot
+          << ",\"ts\":" << (span.begin * 1e-3)
+          << ",\"dur\":" << ((span.end - span.begin) * 1e-3)
+          << ",\"args\":{\"event\":" << span.event << "}}";
+    }
+  }
+  out << "\n]}\n";
+  return static_cast<bool>(out);
+
+}  // end 'Write(std::string&)'
+
+
+
+// ----------------------------------------------------------------------------
+//! Get no. of spans recorded
+// ----------------------------------------------------------------------------
+uint64_t StageTrace::GetNSpans() const
+{
+
+  uint64_t nSpans = 0;
+  for (const Buffer& buffer : m_buffers)
+  {
+    nSpans += buffer.nSpans;
+  }
+  return nSpans;
+
+}  // end 'GetNSpans()'
+
+
+
+// ----------------------------------------------------------------------------
+//! Get no. of spans dropped because a buffer was full
+// ----------------------------------------------------------------------------
+uint64_t StageTrace::GetNDropped() const
+{
+
+  uint64_t nDropped = 0;
+  for (const Buffer& buffer : m_buffers)
+  {
+    nDropped += buffer.nDropped;
+  }
+  return nDropped;
+
+}  // end 'GetNDropped()'
+
+// end ========================================================================
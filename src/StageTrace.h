@@ -0,0 +1,179 @@
+/// ===========================================================================
+/*! \file    StageTrace.h
+ *  \authors Derek Anderson
+ *  \date    10.16.2026
+ *
+ *  Part of the BeamBackgroundFilterAndQA module, this
+ *  records begin/end times of filters and their stages
+ *  for viewing on a timeline (as a Chrome trace).
+ */
+/// ===========================================================================
+
+#ifndef STAGETRACE_H
+#define STAGETRACE_H
+
+// c++ utilities
+#include <cassert>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// module components
+#include "HistAccumulator.h"
+
+
+
+// ============================================================================
+//! Timeline of filter stages
+// ============================================================================
+/*! Spans (a name, a category, and begin/end times) are recorded into a
+ *  buffer per worker slot (see HistAccumulator.h) which is allocated up
+ *  front, so recording never allocates or locks; once a buffer is full,
+ *  further spans on that slot are dropped (and counted). Write then
+ *  dumps every span as a complete ("X") event of the Chrome trace event
+ *  format, which chrome://tracing and ui.perfetto.dev both open, w/ one
+ *  track per slot.
+ *
+ *  Names and categories aren't copied, so they should be string
+ *  literals or otherwise outlive the trace (e.g. filter names).
+ */
+class StageTrace
+{
+
+  public:
+
+    // ========================================================================
+    //! One recorded span
+    // ========================================================================
+    struct Span
+    {
+      const char* name     = "";
+      const char* category = "";
+      uint64_t    begin    = 0;
+      uint64_t    end      = 0;
+      uint64_t    event    = 0;
+    };
+
+    // ========================================================================
+    //! Records a span over its lifetime
+    // ========================================================================
+    /*! Does nothing if the trace is a null pointer, e.g.
+     *
+     *  StageTrace::Scope scope(m_trace, "map build", m_name.data());
+     */
+    class Scope
+    {
+
+      public:
+
+        Scope(StageTrace* trace, const char* name, const char* category)
+          : m_trace(trace)
+          , m_name(name)
+          , m_category(category)
+          , m_begin(trace ? trace->Now() : 0)
+        {}
+
+        ~Scope()
+        {
+          if (m_trace)
+          {
+            m_trace->Record(m_name, m_category, m_begin, m_trace->Now());
+          }
+        }
+
+        // no copying: a scope is one span
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+      private:
+
+        StageTrace* m_trace;
+        const char* m_name;
+        const char* m_category;
+        uint64_t    m_begin;
+
+    };  // end Scope
+
+    // ctor/dtor
+    StageTrace() = default;
+    ~StageTrace() = default;
+
+    // no copying: buffers can be large
+    StageTrace(const StageTrace&) = delete;
+    StageTrace& operator=(const StageTrace&) = delete;
+
+    // open/close trace
+    void Open(const std::size_t nSlots, const std::size_t capacity);
+    void Close();
+
+    // write out trace
+    bool Write(const std::string& path) const;
+
+    // ------------------------------------------------------------------------
+    //! Get time since trace was opened (in ns)
+    // ------------------------------------------------------------------------
+    uint64_t Now() const
+    {
+      return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - m_origin).count();
+    }
+
+    // ------------------------------------------------------------------------
+    //! Set event no. to tag the current thread's spans with
+    // ------------------------------------------------------------------------
+    void SetEvent(const uint64_t event)
+    {
+      assert(WorkerSlot() < m_buffers.size());
+      m_buffers[WorkerSlot()].event = event;
+    }
+
+    // ------------------------------------------------------------------------
+    //! Record a span on the current thread's buffer
+    // ------------------------------------------------------------------------
+    void Record(const char* name, const char* category, const uint64_t begin, const uint64_t end)
+    {
+      assert(WorkerSlot() < m_buffers.size());
+      Buffer& buffer = m_buffers[WorkerSlot()];
+      if (buffer.nSpans < buffer.spans.size())
+      {
+        buffer.spans[buffer.nSpans++] = {name, category, begin, end, buffer.event};
+      }
+      else
+      {
+        ++buffer.nDropped;
+      }
+    }
+
+    ///! get no. of spans recorded and dropped (over all slots)
+    uint64_t GetNSpans() const;
+    uint64_t GetNDropped() const;
+
+    ///! check if trace is being recorded
+    bool IsOpen() const {return !m_buffers.empty();}
+
+  private:
+
+    // ========================================================================
+    //! Spans of one worker slot
+    // ========================================================================
+    /*! Kept on separate cache lines so that slots don't false-share.
+     */
+    struct alignas(64) Buffer
+    {
+      std::vector<Span> spans;
+      std::size_t       nSpans   = 0;
+      uint64_t          event    = 0;
+      uint64_t          nDropped = 0;
+    };
+
+    ///! buffer of each slot
+    std::vector<Buffer> m_buffers;
+
+    ///! when trace was opened
+    std::chrono::steady_clock::time_point m_origin = std::chrono::steady_clock::now();
+
+};  // end StageTrace
+
+#endif
+
+// end ========================================================================
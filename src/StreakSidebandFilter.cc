@@ -14,7 +14,9 @@
 
 // c++ utiilites
 #include <algorithm>
+#include <array>
 #include <iostream>
+#include <memory>
 
 // calo base
 #include <calobase/TowerInfoContainer.h>
@@ -23,15 +25,31 @@
 #include <phool/getClass.h>
 #include <phool/PHCompositeNode.h>
 
-// root libraries
-#include <TH1.h>
-#include <TH2.h>
-
 // module components
 #include "StreakSidebandFilter.h"
 
 
 
+// filter registration ========================================================
+
+namespace
+{
+
+  // --------------------------------------------------------------------------
+  //! Register filter with the filter factory
+  // --------------------------------------------------------------------------
+  [[maybe_unused]] const bool registered = BaseBeamBackgroundFilter::RegisterFilter(
+    "StreakSideband",
+    [](const std::string& name, const bbfqd::Parameters& params)
+    {
+      return std::make_unique<StreakSidebandFilter>(StreakSidebandFilter::ReadConfig(params), name);
+    }
+  );
+
+}  // end anonymous namespace
+
+
+
 // ctor/dtor ==================================================================
 
 // ----------------------------------------------------------------------------
@@ -55,7 +73,15 @@ StreakSidebandFilter::StreakSidebandFilter(const Config& config, const std::stri
   , m_config(config)
 {
 
+  m_hotTowers = OHCalHotTowerTracker({
+    m_config.hotTowerMinEne,
+    m_config.hotTowerMaxOccupancy,
+    m_config.hotTowerWindow,
+    m_config.hotTowerSampleEvery
+  });
+
   m_name = name;
+  SetLogLevel((m_config.debug && (m_config.verbosity > 2)) ? bbfql::Trace : bbfql::Warn);
 
 }  // end ctor(Config&)
 
@@ -75,73 +101,101 @@ StreakSidebandFilter::~StreakSidebandFilter()
 
 // public methods =============================================================
 
+// ----------------------------------------------------------------------------
+//! Create config from parameter block
+// ----------------------------------------------------------------------------
+/*! Any options not in the block keep their default values. Keys which
+ *  aren't options of the filter are fatal.
+ */
+StreakSidebandFilter::Config StreakSidebandFilter::ReadConfig(const bbfqd::Parameters& params)
+{
+
+  bbfqd::CheckParameters(
+    params,
+    {
+      "verbosity",
+      "debug",
+      "minStreakTwrEne",
+      "maxAdjacentTwrEne",
+      "minNumTwrsInStreak",
+      "inNodeName",
+      "maskHotTowers",
+      "hotTowerMinEne",
+      "hotTowerMaxOccupancy",
+      "hotTowerWindow",
+      "hotTowerSampleEvery"
+    },
+    "StreakSidebandFilter"
+  );
+
+  Config config;
+  bbfqd::ReadParameter(params, "verbosity", config.verbosity);
+  bbfqd::ReadParameter(params, "debug", config.debug);
+  bbfqd::ReadParameter(params, "minStreakTwrEne", config.minStreakTwrEne);
+  bbfqd::ReadParameter(params, "maxAdjacentTwrEne", config.maxAdjacentTwrEne);
+  bbfqd::ReadParameter(params, "minNumTwrsInStreak", config.minNumTwrsInStreak);
+  bbfqd::ReadParameter(params, "inNodeName", config.inNodeName);
+  bbfqd::ReadParameter(params, "maskHotTowers", config.maskHotTowers);
+  bbfqd::ReadParameter(params, "hotTowerMinEne", config.hotTowerMinEne);
+  bbfqd::ReadParameter(params, "hotTowerMaxOccupancy", config.hotTowerMaxOccupancy);
+  bbfqd::ReadParameter(params, "hotTowerWindow", config.hotTowerWindow);
+  bbfqd::ReadParameter(params, "hotTowerSampleEvery", config.hotTowerSampleEvery);
+  return config;
+
+}  // end 'ReadConfig(bbfqd::Parameters&)'
+
+
+
+
 // ----------------------------------------------------------------------------
 // Apply filter to check for beam background or not
 // ----------------------------------------------------------------------------
 bool StreakSidebandFilter::ApplyFilter(PHCompositeNode* topNode)
 {
 
-  // print debug message
-  if (m_config.debug && (m_config.verbosity > 2))
-  {
-    std::cout << "StreakSidebandFilter::ApplyFilter() Checking if streak found in OHCal via their sidebands" << std::endl;
-  }
+  // log debug message
+  Log<bbfql::Trace>("StreakSidebandFilter::ApplyFilter() Checking if streak found in OHCal via their sidebands");
 
   // grab input node
   GrabNodes(topNode);
 
   // build tower map
-  m_ohMap.Reset();
-  m_ohMap.Build( m_ohContainer );
-
-  // reset number of streaky towers per eta bin
-  std::fill(m_ohNumStreak.begin(), m_ohNumStreak.end(), 0);
-
-  // lambdas to get phi +- 1 neighbors
-  auto getAdjacentUp   = [this](const std::size_t phi) {return (phi + 1) % m_ohMap.towers.front().size();};
-  auto getAdjacentDown = [this](const std::size_t phi) {return (phi == 0) ? m_ohMap.towers.front().size() : (phi - 1);};
-
-  // loop over tower (eta, phi) map to find streaks
-  for (std::size_t iPhi = 0; iPhi < m_ohMap.towers.front().size(); ++iPhi)
+  //   - n.b. measured (and traced) separately from the rest
+  //     of the filter if reading counters or tracing
   {
-    for (std::size_t iEta = 0; iEta < m_ohMap.towers.size(); ++iEta)
+    StageTrace::Scope trace(m_trace, "map build", m_name.data());
+    const PerfCounters::Sample buildStart = m_perf ? m_perf->Begin() : PerfCounters::Sample();
+    m_ohMap.Reset();
+    m_ohMap.Build( m_ohContainer );
+    if (m_perf)
     {
+      m_perf->End(buildStart, m_buildCounts);
+    }
+  }
 
-      // check if tower is a candidate for being in a streak
-      const bool isNotStreak = IsTowerNotStreaky(m_ohMap.towers[iEta][iPhi]);
-      if (isNotStreak) continue;
+  // and run the algorithm on the map
+  bbfqd::TowerSnapshot snapshot;
+  snapshot.ohcal = m_ohMap.View();
+  ObserveTowers(snapshot.ohcal);
+  return FindStreaks(snapshot.ohcal);
 
-      // grab adjacent towers
-      const std::size_t iUp   = getAdjacentUp(iPhi);
-      const std::size_t iDown = getAdjacentDown(iPhi);
+}  // end 'ApplyFilter(PHCompositeNode*)'
 
-      // and check if adjacent towers consistent w/ a streak
-      const bool isUpNotStreak   = IsNeighborNotStreaky(m_ohMap.towers[iEta][iUp]);
-      const bool isDownNotStreak = IsNeighborNotStreaky(m_ohMap.towers[iEta][iDown]);
-      if (isUpNotStreak || isDownNotStreak) continue;
 
-      // finally, increment no. of streaky towers for this phi
-      // and this phi + 1
-      ++m_ohNumStreak[iPhi];
-      ++m_ohNumStreak[iUp];
 
-      // fill histograms
-      m_hists["nstreakperphi"]->Fill(iPhi);
-      m_hists["nstreakperphi"]->Fill(iPhi);
-      m_hists["nstreaktwretavsphi"]->Fill(iEta, iPhi);
-      m_hists["nstreaktwretavsphi"]->Fill(iEta, iUp);
-
-    }  // end eta loop
-  }  // end phi loop
+// ----------------------------------------------------------------------------
+// Apply filter to a snapshot of an event
+// ----------------------------------------------------------------------------
+bool StreakSidebandFilter::ApplyFilterToSnapshot(const bbfqd::TowerSnapshot& snapshot)
+{
 
-  // now find longest streak
-  const uint32_t nMaxStreak = *std::max_element(m_ohNumStreak.begin(), m_ohNumStreak.end());
-  m_hists["nmaxstreak"]->Fill(nMaxStreak);
+  // log debug message
+  Log<bbfql::Trace>("StreakSidebandFilter::ApplyFilterToSnapshot() Checking if streak found in OHCal snapshot via their sidebands");
 
-  // return if streak length above threshold
-  return (nMaxStreak > m_config.minNumTwrsInStreak);
+  ObserveTowers(snapshot.ohcal);
+  return FindStreaks(snapshot.ohcal);
 
-}  // end 'ApplyFilter()'
+}  // end 'ApplyFilterToSnapshot(bbfqd::TowerSnapshot&)'
 
 
 
@@ -151,11 +205,8 @@ bool StreakSidebandFilter::ApplyFilter(PHCompositeNode* topNode)
 void StreakSidebandFilter::BuildHistograms(const std::string& module, const std::string& tag)
 {
 
-  // print debug message
-  if (m_config.debug && (m_config.verbosity > 2))
-  {
-    std::cout << "StreakSidebandFilter::BuildHistograms(std::string) Constructing histograms" << std::endl;
-  }
+  // log debug message
+  Log<bbfql::Info>("StreakSidebandFilter::BuildHistograms(std::string) Constructing histograms");
 
   // make sure module name is lower case
   std::string moduleAndFilterName = module + "_" + m_name;
@@ -171,18 +222,70 @@ void StreakSidebandFilter::BuildHistograms(const std::string& module, const std:
   std::vector<std::string> histNames = bbfqd::MakeQAHistNames(varNames, moduleAndFilterName, tag);
 
   // construct histograms
-  //   - n.b. reminder that there are
+  //   - n.b. binning follows ohcal geometry, i.e.
   //       24 ohcal towers in eta
   //       64 ohcal towers in phi
-  m_hists[varNames[0]] = new TH1D(histNames[0].data(), "", 25, -0.5, 24.5);
-  m_hists[varNames[1]] = new TH1D(histNames[1].data(), "", 65, -0.5, 64.5);
-  m_hists[varNames[2]] = new TH2D(histNames[2].data(), "", 25, -0.5, 24.5, 65, -0.5, 64.5);
+  //     with one bin per tower index (plus one)
+  const std::size_t nEta = bbfqd::OHCalMap::nEta;
+  const std::size_t nPhi = bbfqd::OHCalMap::nPhi;
+  BuildHistogram(varNames[0], histNames[0], {nEta + 1, -0.5, nEta + 0.5});
+  BuildHistogram(varNames[1], histNames[1], {nPhi + 1, -0.5, nPhi + 0.5});
+  BuildHistogram(varNames[2], histNames[2], {nEta + 1, -0.5, nEta + 0.5, nPhi + 1, -0.5, nPhi + 0.5});
+
+  // and create integer counters to fill them
+  m_nMaxStreak         = MakeAccumulator(varNames[0]);
+  m_nStreakPerPhi      = MakeAccumulator(varNames[1]);
+  m_nStreakTwrEtaVsPhi = MakeAccumulator(varNames[2]);
+
+  // tabulate bins of each tower index, so
+  // fills don't need to search for them
+  for (std::size_t iPhi = 0; iPhi < nPhi; ++iPhi)
+  {
+    m_phiBins[iPhi] = m_nStreakPerPhi.FindBin(iPhi);
+    for (std::size_t iEta = 0; iEta < nEta; ++iEta)
+    {
+      m_etaPhiBins[(iEta * nPhi) + iPhi] = m_nStreakTwrEtaVsPhi.FindBin(iEta, iPhi);
+    }
+  }
   return;
 
 }  // end 'BuildHistograms(std::string&, std::string&)'
 
 
 
+// ----------------------------------------------------------------------------
+//! Add counted fills to histograms
+// ----------------------------------------------------------------------------
+void StreakSidebandFilter::MergeHistograms()
+{
+
+  // log debug message
+  Log<bbfql::Info>("StreakSidebandFilter::MergeHistograms() Merging counters into histograms");
+
+  m_nMaxStreak.Merge();
+  m_nStreakPerPhi.Merge();
+  m_nStreakTwrEtaVsPhi.Merge();
+  return;
+
+}  // end 'MergeHistograms()'
+
+
+
+// ----------------------------------------------------------------------------
+//! Get memory used for QA
+// ----------------------------------------------------------------------------
+std::size_t StreakSidebandFilter::GetQABytes() const
+{
+
+  return BaseBeamBackgroundFilter::GetQABytes() +
+         m_nMaxStreak.GetBytes() +
+         m_nStreakPerPhi.GetBytes() +
+         m_nStreakTwrEtaVsPhi.GetBytes();
+
+}  // end 'GetQABytes()'
+
+
+
 // private methods ============================================================
 
 // ----------------------------------------------------------------------------
@@ -191,11 +294,8 @@ void StreakSidebandFilter::BuildHistograms(const std::string& module, const std:
 void StreakSidebandFilter::GrabNodes(PHCompositeNode* topNode)
 {
 
-  // print debug message
-  if (m_config.debug && (m_config.verbosity > 2))
-  {
-    std::cout << "StreakSidebandFilter::GrabNodes(PHCompositeNode*) Grabbing input nodes" << std::endl;
-  }
+  // log debug message
+  Log<bbfql::Info>("StreakSidebandFilter::GrabNodes(PHCompositeNode*) Grabbing input nodes");
 
   m_ohContainer = findNode::getClass<TowerInfoContainer>(topNode, m_config.inNodeName);
   return;
@@ -207,39 +307,173 @@ void StreakSidebandFilter::GrabNodes(PHCompositeNode* topNode)
 // ----------------------------------------------------------------------------
 //! Check if tower not consistent w/ being in a streak
 // ----------------------------------------------------------------------------
-bool StreakSidebandFilter::IsTowerNotStreaky(const bbfqd::Tower& tower)
+/*! n.b. this and IsNeighborNotStreaky are called for every tower, so
+ *  they're kept free of debug printout and branches (hence '|' rather
+ *  than '||'). Hot towers are treated the same as towers w/ bad status.
+ */
+bool StreakSidebandFilter::IsTowerNotStreaky(const bbfqd::Tower& tower, const bool isHot) const
 {
 
-  // print debug message
-  if (m_config.debug && (m_config.verbosity > 2))
-  {
-    std::cout << "StreakSidebandFilter::IsTowerNotStreaky() Checking if tower not consistent w/ streak" << std::endl;
-  }
-
-  const bool isBadStatus   = (tower.status != 1);
+  const bool isBadStatus   = (tower.status != 1) | isHot;
   const bool isBelowEneCut = (tower.energy < m_config.minStreakTwrEne);
-  return (isBadStatus || isBelowEneCut);
+  return (isBadStatus | isBelowEneCut);
 
-}  // end 'IsTowerNotStreaky(Tower& tower)'
+}  // end 'IsTowerNotStreaky(Tower& tower, bool)'
 
 
 
 // ----------------------------------------------------------------------------
 //! Check if a neighboring tower consistent w/ a streak
 // ----------------------------------------------------------------------------
-bool StreakSidebandFilter::IsNeighborNotStreaky(const bbfqd::Tower& tower)
+bool StreakSidebandFilter::IsNeighborNotStreaky(const bbfqd::Tower& tower, const bool isHot) const
 {
 
-  // print debug message
-  if (m_config.debug && (m_config.verbosity > 2))
+  const bool isBadStatus   = (tower.status != 1) | isHot;
+  const bool isAboveEneCut = (tower.energy > m_config.maxAdjacentTwrEne);
+  return (isBadStatus | isAboveEneCut);
+
+}  // end 'IsNeighborNotStreaky(Tower& tower, bool)'
+
+
+
+// ----------------------------------------------------------------------------
+//! Pass an event to the hot-tower tracker, if masking
+// ----------------------------------------------------------------------------
+void StreakSidebandFilter::ObserveTowers(const bbfqd::TowerView& ohView)
+{
+
+  if (m_config.maskHotTowers)
   {
-    std::cout << "StreakSidebandFilter::IsNeighborNotStreaky() Checking if neighboring tower not consistent w/ streak" << std::endl;
+    StageTrace::Scope trace(m_trace, "hot-tower update", m_name.data());
+    m_hotTowers.Observe(ohView);
   }
+  return;
 
-  const bool isBadStatus   = (tower.status != 1);
-  const bool isAboveEneCut = (tower.energy > m_config.maxAdjacentTwrEne);
-  return (isBadStatus || isAboveEneCut);
+}  // end 'ObserveTowers(bbfqd::TowerView&)'
+
+
+
+// ----------------------------------------------------------------------------
+//! Look for streaks in an (eta, phi) map of OHCal towers
+// ----------------------------------------------------------------------------
+/*! Returns true if the longest streak found is above threshold.
+ */
+bool StreakSidebandFilter::FindStreaks(const bbfqd::TowerView& ohView)
+{
+
+  // no. of streaky towers per phi bin
+  //   - n.b. kept local so that several
+  //     events can be checked at once
+  std::array<std::size_t, bbfqd::OHCalMap::nPhi> nStreak;
+  nStreak.fill(0);
+
+  // if no towers to check (or map doesn't match
+  // ohcal geometry), there's nothing to find
+  const bool isBadView = (ohView.nEta > bbfqd::OHCalMap::nEta) || (ohView.nPhi > bbfqd::OHCalMap::nPhi);
+  if (!ohView.IsValid() || isBadView) return false;
+
+  // buffer of (eta, phi) indices of streaky towers found in this event,
+  // so that histograms can be filled in one go after the scan
+  std::array<uint8_t, bbfqd::OHCalMap::nEta * bbfqd::OHCalMap::nPhi> hitEta;
+  std::array<uint8_t, bbfqd::OHCalMap::nEta * bbfqd::OHCalMap::nPhi> hitPhi;
+  std::size_t nHits = 0;
+
+  // loop over tower (eta, phi) map to find streaks
+  const uint64_t scanStart = m_trace ? m_trace->Now() : 0;
+  for (std::size_t iPhi = 0; iPhi < ohView.nPhi; ++iPhi)
+  {
+
+    // grab adjacent phi slices
+    const std::size_t iUp   = (iPhi + 1) % ohView.nPhi;
+    const std::size_t iDown = (iPhi == 0) ? (ohView.nPhi - 1) : (iPhi - 1);
+
+    for (std::size_t iEta = 0; iEta < ohView.nEta; ++iEta)
+    {
+
+      // check if tower is a candidate for being in a streak, and
+      // if adjacent towers are consistent w/ a streak
+      //   - n.b. all three checks are always made and combined
+      //     w/ '&' (not '&&', which would short-circuit), so
+      //     there are no data-dependent branches here
+      //   - n.b. the hot-tower mask is all zeroes unless masking
+      const bool isCandidate = !IsTowerNotStreaky(ohView.At(iEta, iPhi), m_hotTowers.IsHot(iEta, iPhi));
+      const bool isUpQuiet   = !IsNeighborNotStreaky(ohView.At(iEta, iUp), m_hotTowers.IsHot(iEta, iUp));
+      const bool isDownQuiet = !IsNeighborNotStreaky(ohView.At(iEta, iDown), m_hotTowers.IsHot(iEta, iDown));
+      const bool isStreak    = isCandidate & isUpQuiet & isDownQuiet;
+
+      // increment no. of streaky towers for this phi
+      // and this phi + 1
+      nStreak[iPhi] += isStreak;
+      nStreak[iUp]  += isStreak;
+
+      // record tower (only kept if it's streaky)
+      //   - n.b. this compaction (store always, advance if
+      //     streaky) avoids a branch, but its data-dependent
+      //     index keeps the loop from being vectorized
+      hitEta[nHits] = iEta;
+      hitPhi[nHits] = iPhi;
+      nHits        += isStreak;
+
+    }  // end eta loop
+  }  // end phi loop
+  if (m_trace)
+  {
+    m_trace->Record("candidate scan", m_name.data(), scanStart, m_trace->Now());
+  }
+
+  // now find longest streak
+  const uint32_t nMaxStreak = *std::max_element(nStreak.begin(), nStreak.end());
+
+  // fill histograms (streaky towers from buffer), if needed
+  if (m_fillQA)
+  {
+    StageTrace::Scope trace(m_trace, "QA fill", m_name.data());
+    if (nHits > 0)
+    {
+      FillStreakHists(hitEta.data(), hitPhi.data(), nHits, ohView.nPhi);
+    }
+    m_nMaxStreak.Fill(nMaxStreak);
+  }
+
+  // return if streak length above threshold
+  return (nMaxStreak > m_config.minNumTwrsInStreak);
+
+}  // end 'FindStreaks(bbfqd::TowerView&)'
+
+
+
+// ----------------------------------------------------------------------------
+//! Fill streak histograms from a buffer of streaky towers
+// ----------------------------------------------------------------------------
+/*! Each streaky tower counts twice towards its phi bin, and once each
+ *  towards its (eta, phi) and (eta, phi + 1) bins.
+ */
+void StreakSidebandFilter::FillStreakHists(
+  const uint8_t* hitEta,
+  const uint8_t* hitPhi,
+  const std::size_t nHits,
+  const std::size_t nPhi
+) {
+
+  // translate (eta, phi) indices to bins
+  //   - n.b. via the lookup tables, since histograms
+  //     may have been downsampled to fit the qa budget
+  constexpr std::size_t nPhiMap = bbfqd::OHCalMap::nPhi;
+  std::array<uint16_t, bbfqd::OHCalMap::nEta * nPhiMap>     phiBins;
+  std::array<uint16_t, 2 * bbfqd::OHCalMap::nEta * nPhiMap> etaPhiBins;
+  for (std::size_t iHit = 0; iHit < nHits; ++iHit)
+  {
+    const std::size_t iUp = (hitPhi[iHit] + 1) % nPhi;
+    phiBins[iHit]            = m_phiBins[hitPhi[iHit]];
+    etaPhiBins[2 * iHit]     = m_etaPhiBins[(hitEta[iHit] * nPhiMap) + hitPhi[iHit]];
+    etaPhiBins[2 * iHit + 1] = m_etaPhiBins[(hitEta[iHit] * nPhiMap) + iUp];
+  }
+
+  // and fill in bulk
+  m_nStreakPerPhi.IncrementN(phiBins.data(), nHits, 2);
+  m_nStreakTwrEtaVsPhi.IncrementN(etaPhiBins.data(), 2 * nHits);
+  return;
 
-}  // end 'IsNeighborNotStreaky(Tower& tower)'
+}  // end 'FillStreakHists(uint8_t*, uint8_t*, std::size_t, std::size_t)'
 
 // end ========================================================================
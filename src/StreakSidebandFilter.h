@@ -15,18 +15,24 @@
 
 // c++ utilities
 #include <array>
+#include <cstdint>
 #include <string>
+#include <vector>
 
 // module components
 #include "BaseBeamBackgroundFilter.h"
 #include "BeamBackgroundFilterAndQADefs.h"
+#include "BeamBackgroundFilterAndQALog.h"
+#include "HistAccumulator.h"
+#include "HotTowerTracker.h"
 
 // forward declarations
 class PHCompositeNode;
 class TowerInfoContainer;
 
-// alias for convenience
+// aliases for convenience
 namespace bbfqd = BeamBackgroundFilterAndQADefs;
+namespace bbfql = BeamBackgroundFilterAndQALog;
 
 
 
@@ -37,7 +43,7 @@ namespace bbfqd = BeamBackgroundFilterAndQADefs;
  *  in the OHCal by comparing streak candidates vs.
  *  their sidebands, i.e. adjacent phi slices.
  */
-class StreakSidebandFilter : public BaseBeamBackgroundFilter
+class StreakSidebandFilter final : public BaseBeamBackgroundFilter
 {
 
   public:
@@ -48,11 +54,20 @@ class StreakSidebandFilter : public BaseBeamBackgroundFilter
     struct Config
     {
       int         verbosity          = 0;
-      bool        debug              = true;
+      bool        debug              = false;
       float       minStreakTwrEne    = 0.6;
       float       maxAdjacentTwrEne  = 0.06;
       uint32_t    minNumTwrsInStreak = 5;
       std::string inNodeName         = "TOWERINFO_CALIB_HCALOUT";
+
+      ///! hot-tower masking: if on, towers which are above
+      ///! hotTowerMinEne in more than hotTowerMaxOccupancy of
+      ///! (sampled) events are treated like bad-status towers
+      bool     maskHotTowers        = false;
+      float    hotTowerMinEne       = 0.6;
+      double   hotTowerMaxOccupancy = 0.05;
+      uint32_t hotTowerWindow       = 2000;
+      uint32_t hotTowerSampleEvery  = 10;
     };
 
     // ctor/dtor
@@ -60,9 +75,18 @@ class StreakSidebandFilter : public BaseBeamBackgroundFilter
     StreakSidebandFilter(const Config& cfg, const std::string& name = "StreakSideband");
     ~StreakSidebandFilter();
 
+    // create config from parameter block
+    static Config ReadConfig(const bbfqd::Parameters& params);
+
     // inherited methods
     bool ApplyFilter(PHCompositeNode* topNode) override;
+    bool ApplyFilterToSnapshot(const bbfqd::TowerSnapshot& snapshot) override;
     void BuildHistograms(const std::string& module, const std::string& tag = "") override;
+    void MergeHistograms() override;
+    std::size_t GetQABytes() const override;
+
+    ///! get hot-tower tracker
+    const OHCalHotTowerTracker& GetHotTowers() const {return m_hotTowers;}
 
   private:
 
@@ -70,18 +94,33 @@ class StreakSidebandFilter : public BaseBeamBackgroundFilter
     void GrabNodes(PHCompositeNode* topNode) override;
 
     // filter-specific methods
-    bool IsTowerNotStreaky(const bbfqd::Tower& tower);
-    bool IsNeighborNotStreaky(const bbfqd::Tower& tower);
+    bool IsTowerNotStreaky(const bbfqd::Tower& tower, const bool isHot) const;
+    bool IsNeighborNotStreaky(const bbfqd::Tower& tower, const bool isHot) const;
+    void ObserveTowers(const bbfqd::TowerView& ohView);
+    bool FindStreaks(const bbfqd::TowerView& ohView);
+    void FillStreakHists(const uint8_t* hitEta, const uint8_t* hitPhi, const std::size_t nHits, const std::size_t nPhi);
 
     ///! input node
     TowerInfoContainer* m_ohContainer;
 
-    ///! no. of streaks per event in ohcal
-    std::array<std::size_t, 64> m_ohNumStreak;
+    ///! counters for streak histograms: these are
+    ///! filled in bulk by (eta, phi) bin
+    HistAccumulator<uint64_t> m_nMaxStreak;
+    HistAccumulator<uint64_t> m_nStreakPerPhi;
+    HistAccumulator<uint64_t> m_nStreakTwrEtaVsPhi;
+
+    ///! lookup tables of phi and (eta, phi) bins of the streak
+    ///! histograms for each tower index, built from the binning
+    ///! the histograms were actually built w/
+    std::array<uint16_t, bbfqd::OHCalMap::nPhi>                         m_phiBins    = {};
+    std::array<uint16_t, bbfqd::OHCalMap::nEta * bbfqd::OHCalMap::nPhi> m_etaPhiBins = {};
 
     ///! tower info (eta, phi) map
     bbfqd::OHCalMap m_ohMap;
 
+    ///! hot-tower tracker
+    OHCalHotTowerTracker m_hotTowers;
+
     ///! configuration
     Config m_config; 
 
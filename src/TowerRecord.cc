@@ -0,0 +1,489 @@
+/// ===========================================================================
+/*! \file    TowerRecord.cc
+ *  \authors Derek Anderson
+ *  \date    10.16.2026
+ *
+ *  Part of the BeamBackgroundFilterAndQA module, this
+ *  defines a compact binary format for recorded tower
+ *  snapshots, which can be replayed through filters
+ *  without ROOT I/O or a node tree.
+ */
+/// ===========================================================================
+
+#define TOWERRECORD_CC
+
+// c++ utiilites
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <limits>
+
+// system utilities
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// compression
+#include <zlib.h>
+
+// module components
+#include "TowerRecord.h"
+
+// alias for convenience
+namespace bbfqd = BeamBackgroundFilterAndQADefs;
+
+
+
+namespace
+{
+
+  ///! bytes per tower in the payload: status + energy + time
+  constexpr std::size_t BytesPerTower = sizeof(uint8_t) + (2 * sizeof(float));
+
+  ///! largest payload of an event (block sizes are stored as u32)
+  constexpr std::size_t MaxPayloadSize = std::numeric_limits<uint32_t>::max();
+
+  ///! size of the trailer
+  constexpr std::size_t TrailerSize = (2 * sizeof(uint64_t)) + (2 * sizeof(uint32_t));
+
+  static_assert(sizeof(TowerRecord::IndexEntry) == 24, "Index entries must be packed");
+
+  // --------------------------------------------------------------------------
+  //! Helper to write plain values
+  // --------------------------------------------------------------------------
+  template <typename T> void Put(std::ofstream& out, const T value)
+  {
+    out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+  }
+
+  // --------------------------------------------------------------------------
+  //! Bounds-checked reader over a buffer
+  // --------------------------------------------------------------------------
+  struct Cursor
+  {
+    const char* data;
+    std::size_t size;
+    std::size_t pos = 0;
+
+    template <typename T> bool Get(T& value)
+    {
+      if (pos + sizeof(T) > size) return false;
+      std::memcpy(&value, data + pos, sizeof(T));
+      pos += sizeof(T);
+      return true;
+    }
+
+    bool GetString(std::string& value)
+    {
+      uint32_t length = 0;
+      if (!Get(length) || (pos + length > size)) return false;
+      value.assign(data + pos, length);
+      pos += length;
+      return true;
+    }
+  };
+
+  // --------------------------------------------------------------------------
+  //! Split floats into byte planes, and back
+  // --------------------------------------------------------------------------
+  /*! Plane k holds bits [8k, 8k + 8) of each value, least significant
+   *  first, so the layout doesn't depend on byte order.
+   */
+  void SplitPlanes(const float* values, const std::size_t nValues, uint8_t* planes)
+  {
+    for (std::size_t iValue = 0; iValue < nValues; ++iValue)
+    {
+      uint32_t bits;
+      std::memcpy(&bits, &values[iValue], sizeof(float));
+      planes[iValue]                 = bits;
+      planes[nValues + iValue]       = bits >> 8;
+      planes[(2 * nValues) + iValue] = bits >> 16;
+      planes[(3 * nValues) + iValue] = bits >> 24;
+    }
+  }
+
+  float JoinPlanes(const uint8_t* planes, const std::size_t nValues, const std::size_t iValue)
+  {
+    const uint32_t bits = static_cast<uint32_t>(planes[iValue]) |
+                          (static_cast<uint32_t>(planes[nValues + iValue]) << 8) |
+                          (static_cast<uint32_t>(planes[(2 * nValues) + iValue]) << 16) |
+                          (static_cast<uint32_t>(planes[(3 * nValues) + iValue]) << 24);
+
+    float value;
+    std::memcpy(&value, &bits, sizeof(float));
+    return value;
+  }
+
+  // --------------------------------------------------------------------------
+  //! Get total payload size of an event
+  // --------------------------------------------------------------------------
+  std::size_t GetPayloadSize(const std::vector<TowerRecord::Detector>& detectors)
+  {
+    std::size_t size = 0;
+    for (const auto& detector : detectors)
+    {
+      size += detector.GetNTowers() * BytesPerTower;
+    }
+    return size;
+  }
+
+}  // end anonymous namespace
+
+
+
+namespace TowerRecord
+{
+
+  // writer ===================================================================
+
+  // --------------------------------------------------------------------------
+  //! Writer dtor
+  // --------------------------------------------------------------------------
+  /*! Closes the file if it's still open, so that it's readable.
+   */
+  Writer::~Writer()
+  {
+    if (IsOpen())
+    {
+      Close();
+    }
+  }
+
+
+
+  // --------------------------------------------------------------------------
+  //! Open a record and write its header
+  // --------------------------------------------------------------------------
+  /*! Each calorimeter can only be recorded once. Returns false if the
+   *  calorimeters don't make sense or the file can't be opened.
+   */
+  bool Writer::Open(const std::string& path, const std::vector<Detector>& detectors, const int level)
+  {
+
+    // check calorimeters
+    std::array<bool, NCalos> isUsed = {false, false, false};
+    for (const auto& detector : detectors)
+    {
+      const bool isGood = (detector.calo < NCalos) && !isUsed[detector.calo] && (detector.GetNTowers() > 0);
+      if (!isGood)
+      {
+        std::cerr << "TowerRecord::Writer::Open() WARNING: bad or repeated calorimeter (node '" << detector.node << "')!" << std::endl;
+        return false;
+      }
+      isUsed[detector.calo] = true;
+    }
+
+    m_file.open(path, std::ios::binary | std::ios::trunc);
+    if (!m_file)
+    {
+      std::cerr << "TowerRecord::Writer::Open() WARNING: couldn't open '" << path << "' for writing!" << std::endl;
+      return false;
+    }
+
+    // write header
+    m_level = std::clamp(level, 0, 9);
+    Put<uint32_t>(m_file, Magic);
+    Put<uint32_t>(m_file, Version);
+    Put<uint32_t>(m_file, m_level);
+    Put<uint32_t>(m_file, detectors.size());
+    for (const auto& detector : detectors)
+    {
+      Put<uint32_t>(m_file, detector.calo);
+      Put<uint32_t>(m_file, detector.nEta);
+      Put<uint32_t>(m_file, detector.nPhi);
+      Put<uint32_t>(m_file, detector.node.size());
+      m_file.write(detector.node.data(), detector.node.size());
+    }
+    m_offset = m_file.tellp();
+
+    // and set up buffers
+    m_detectors = detectors;
+    m_channels.resize(detectors.size());
+    for (std::size_t iDetector = 0; iDetector < detectors.size(); ++iDetector)
+    {
+      m_channels[iDetector].Reset(detectors[iDetector].GetNTowers());
+    }
+    m_payload.resize(GetPayloadSize(detectors));
+    m_compressed.resize(compressBound(m_payload.size()));
+    m_index.clear();
+    return static_cast<bool>(m_file);
+
+  }  // end 'Open(std::string&, std::vector<Detector>&, int)'
+
+
+
+  // --------------------------------------------------------------------------
+  //! Write the current channels as one event
+  // --------------------------------------------------------------------------
+  bool Writer::Write(const uint32_t run, const uint64_t event)
+  {
+
+    if (!IsOpen()) return false;
+
+    // lay out payload
+    uint8_t* payload = m_payload.data();
+    for (std::size_t iDetector = 0; iDetector < m_detectors.size(); ++iDetector)
+    {
+      const std::size_t nTowers  = m_detectors[iDetector].GetNTowers();
+      const Channels&   channels = m_channels[iDetector];
+      if ((channels.status.size() != nTowers) || (channels.energy.size() != nTowers) || (channels.time.size() != nTowers))
+      {
+        std::cerr << "TowerRecord::Writer::Write() WARNING: channels of '" << m_detectors[iDetector].node << "' were resized!" << std::endl;
+        return false;
+      }
+
+      std::memcpy(payload, channels.status.data(), nTowers);
+      SplitPlanes(channels.energy.data(), nTowers, payload + nTowers);
+      SplitPlanes(channels.time.data(), nTowers, payload + (nTowers * (1 + sizeof(float))));
+      payload += nTowers * BytesPerTower;
+    }
+
+    // deflate, if needed, and write
+    const uint8_t* block = m_payload.data();
+    uLongf         size  = m_payload.size();
+    if (m_level > 0)
+    {
+      size = m_compressed.size();
+      if (compress2(m_compressed.data(), &size, m_payload.data(), m_payload.size(), m_level) != Z_OK)
+      {
+        std::cerr << "TowerRecord::Writer::Write() WARNING: couldn't compress event " << event << "!" << std::endl;
+        return false;
+      }
+      block = m_compressed.data();
+    }
+    m_file.write(reinterpret_cast<const char*>(block), size);
+
+    m_index.push_back({m_offset, event, run, static_cast<uint32_t>(size)});
+    m_offset += size;
+    return static_cast<bool>(m_file);
+
+  }  // end 'Write(uint32_t, uint64_t)'
+
+
+
+  // --------------------------------------------------------------------------
+  //! Write index + trailer and close the record
+  // --------------------------------------------------------------------------
+  bool Writer::Close()
+  {
+
+    if (!IsOpen()) return false;
+
+    const uint64_t indexOffset = m_offset;
+    m_file.write(reinterpret_cast<const char*>(m_index.data()), m_index.size() * sizeof(IndexEntry));
+    Put<uint64_t>(m_file, indexOffset);
+    Put<uint64_t>(m_file, m_index.size());
+    Put<uint32_t>(m_file, Magic);
+    Put<uint32_t>(m_file, 0);
+
+    const bool isGood = static_cast<bool>(m_file);
+    m_file.close();
+    return isGood;
+
+  }  // end 'Close()'
+
+
+
+  // reader ===================================================================
+
+  // --------------------------------------------------------------------------
+  //! Reader dtor
+  // --------------------------------------------------------------------------
+  Reader::~Reader()
+  {
+    Close();
+  }
+
+
+
+  // --------------------------------------------------------------------------
+  //! Map a record and read its header + trailer
+  // --------------------------------------------------------------------------
+  /*! Returns false if the file can't be mapped or isn't a (complete)
+   *  tower record.
+   */
+  bool Reader::Open(const std::string& path)
+  {
+
+    Close();
+
+    // map file
+    const int fd = open(path.data(), O_RDONLY);
+    if (fd < 0)
+    {
+      std::cerr << "TowerRecord::Reader::Open() WARNING: couldn't open '" << path << "'!" << std::endl;
+      return false;
+    }
+
+    struct stat info;
+    if ((fstat(fd, &info) != 0) || (info.st_size <= 0))
+    {
+      close(fd);
+      return false;
+    }
+
+    void* mapped = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mapped == MAP_FAILED)
+    {
+      std::cerr << "TowerRecord::Reader::Open() WARNING: couldn't map '" << path << "'!" << std::endl;
+      return false;
+    }
+    m_data = static_cast<const char*>(mapped);
+    m_size = info.st_size;
+    madvise(mapped, m_size, MADV_SEQUENTIAL);
+
+    // read header
+    Cursor   header = {m_data, m_size};
+    uint32_t magic  = 0;
+    uint32_t version = 0;
+    uint32_t level   = 0;
+    uint32_t nDetectors = 0;
+    bool     isGood = header.Get(magic) && (magic == Magic) &&
+                      header.Get(version) && (version == Version) &&
+                      header.Get(level) && header.Get(nDetectors) &&
+                      (nDetectors <= NCalos);
+    //   - n.b. like the writer, each calorimeter may only
+    //     appear once, and w/ a payload which fits a block
+    std::array<bool, NCalos> isUsed = {false, false, false};
+    std::size_t              nPayloadTowers = 0;
+    for (uint32_t iDetector = 0; isGood && (iDetector < nDetectors); ++iDetector)
+    {
+      Detector detector;
+      uint32_t calo = 0;
+      isGood = header.Get(calo) && (calo < NCalos) && !isUsed[calo] &&
+               header.Get(detector.nEta) && header.Get(detector.nPhi) &&
+               (detector.GetNTowers() > 0) &&
+               (detector.GetNTowers() <= (MaxPayloadSize / BytesPerTower) - nPayloadTowers) &&
+               header.GetString(detector.node);
+      if (!isGood) break;
+
+      detector.calo  = static_cast<Calo>(calo);
+      isUsed[calo]   = true;
+      nPayloadTowers += detector.GetNTowers();
+      m_detectors.push_back(detector);
+    }
+
+    // read trailer
+    //   - n.b. the no. of events is checked against the
+    //     space left for the index, so that a corrupt
+    //     count can't wrap around
+    Cursor   trailer = {m_data, m_size, m_size - std::min(m_size, TrailerSize)};
+    uint32_t endMagic = 0;
+    isGood = isGood && (m_size >= header.pos + TrailerSize) &&
+             trailer.Get(m_index) && trailer.Get(m_nEvents) &&
+             trailer.Get(endMagic) && (endMagic == Magic) &&
+             (m_index >= header.pos) &&
+             (m_index <= m_size - TrailerSize) &&
+             (m_nEvents <= (m_size - TrailerSize - m_index) / sizeof(IndexEntry)) &&
+             (m_index + (m_nEvents * sizeof(IndexEntry)) + TrailerSize == m_size);
+    if (!isGood)
+    {
+      std::cerr << "TowerRecord::Reader::Open() WARNING: '" << path << "' isn't a complete tower record!" << std::endl;
+      Close();
+      return false;
+    }
+
+    m_level = level;
+    m_payload.resize(GetPayloadSize(m_detectors));
+    return true;
+
+  }  // end 'Open(std::string&)'
+
+
+
+  // --------------------------------------------------------------------------
+  //! Read an event
+  // --------------------------------------------------------------------------
+  /*! Returns false if the event doesn't exist or is corrupt.
+   */
+  bool Reader::Read(const uint64_t iEvent, Event& event)
+  {
+
+    if (!m_data || (iEvent >= m_nEvents)) return false;
+
+    IndexEntry entry;
+    std::memcpy(&entry, m_data + m_index + (iEvent * sizeof(IndexEntry)), sizeof(IndexEntry));
+    if ((entry.offset > m_index) || (entry.size > m_index - entry.offset)) return false;
+
+    // inflate block, if needed
+    //   - n.b. uncompressed blocks are read in place
+    const uint8_t* payload = reinterpret_cast<const uint8_t*>(m_data + entry.offset);
+    if (m_level > 0)
+    {
+      uLongf size = m_payload.size();
+      const int status = uncompress(m_payload.data(), &size, payload, entry.size);
+      if ((status != Z_OK) || (size != m_payload.size())) return false;
+      payload = m_payload.data();
+    }
+    else if (entry.size != m_payload.size())
+    {
+      return false;
+    }
+
+    // unpack towers
+    event.run      = entry.run;
+    event.event    = entry.event;
+    event.snapshot = bbfqd::TowerSnapshot();
+    for (const auto& detector : m_detectors)
+    {
+      const std::size_t           nTowers = detector.GetNTowers();
+      std::vector<bbfqd::Tower>&  towers  = event.towers[detector.calo];
+      std::vector<float>&         times   = event.times[detector.calo];
+      towers.resize(nTowers);
+      times.resize(nTowers);
+
+      const uint8_t* energies = payload + nTowers;
+      const uint8_t* stamps   = payload + (nTowers * (1 + sizeof(float)));
+      for (std::size_t iTwr = 0; iTwr < nTowers; ++iTwr)
+      {
+        towers[iTwr].status = payload[iTwr];
+        towers[iTwr].energy = JoinPlanes(energies, nTowers, iTwr);
+        times[iTwr]         = JoinPlanes(stamps, nTowers, iTwr);
+      }
+      payload += nTowers * BytesPerTower;
+
+      const bbfqd::TowerView view = {towers.data(), detector.nEta, detector.nPhi};
+      switch (detector.calo)
+      {
+        case EMCal:
+          event.snapshot.emcal = view;
+          break;
+        case IHCal:
+          event.snapshot.ihcal = view;
+          break;
+        default:
+          event.snapshot.ohcal = view;
+          break;
+      }
+    }
+    return true;
+
+  }  // end 'Read(uint64_t, Event&)'
+
+
+
+  // --------------------------------------------------------------------------
+  //! Unmap record
+  // --------------------------------------------------------------------------
+  void Reader::Close()
+  {
+
+    if (m_data)
+    {
+      munmap(const_cast<char*>(m_data), m_size);
+    }
+    m_data    = nullptr;
+    m_size    = 0;
+    m_level   = 0;
+    m_nEvents = 0;
+    m_index   = 0;
+    m_detectors.clear();
+    return;
+
+  }  // end 'Close()'
+
+}  // end TowerRecord namespace
+
+// end ========================================================================
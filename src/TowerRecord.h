@@ -0,0 +1,237 @@
+/// ===========================================================================
+/*! \file    TowerRecord.h
+ *  \authors Derek Anderson
+ *  \date    10.16.2026
+ *
+ *  Part of the BeamBackgroundFilterAndQA module, this
+ *  defines a compact binary format for recorded tower
+ *  snapshots, which can be replayed through filters
+ *  without ROOT I/O or a node tree.
+ */
+/// ===========================================================================
+
+#ifndef TOWERRECORD_H
+#define TOWERRECORD_H
+
+// c++ utilities
+#include <array>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+// module components
+#include "BeamBackgroundFilterAndQADefs.h"
+
+
+
+// ============================================================================
+//! Tower record format
+// ============================================================================
+/*! A tower record holds the towers of one or more calorimeters for a
+ *  sequence of events, laid out as (in native byte order):
+ *
+ *    header: magic (u32), version (u32), compression level (u32),
+ *            no. of calorimeters (u32)
+ *    for each calorimeter:
+ *      calo (u32: 0 = EMCal, 1 = IHCal, 2 = OHCal), nEta (u32),
+ *      nPhi (u32), node name length (u32) + node name
+ *    for each event, a block of (possibly deflated) payload:
+ *      for each calorimeter, in (eta, phi) row-major order:
+ *        status of each tower (u8)
+ *        energy of each tower (f32), split into 4 byte planes
+ *          (least significant byte first)
+ *        time of each tower (f32), split the same way
+ *    index: for each event, offset of block (u64), event no. (u64),
+ *           run no. (u32), size of block (u32)
+ *    trailer: offset of index (u64), no. of events (u64), magic (u32),
+ *             padding (u32)
+ *
+ *  Splitting floats into byte planes puts the (mostly similar) sign +
+ *  exponent bytes next to each other, which is what makes the payload
+ *  compress well. With a compression level of 0, blocks are stored as
+ *  is. Since the index is at the end, a file is only readable once the
+ *  writer has been closed; after that it can be memory-mapped and any
+ *  event read directly.
+ */
+namespace TowerRecord
+{
+
+  ///! file identifiers
+  inline constexpr uint32_t Magic   = 0x52464242;  // "BBFR"
+  inline constexpr uint32_t Version = 1;
+
+  ///! calorimeters which can be recorded
+  enum Calo : uint32_t {EMCal, IHCal, OHCal, NCalos};
+
+  // ==========================================================================
+  //! A recorded calorimeter
+  // ==========================================================================
+  struct Detector
+  {
+    Calo        calo = OHCal;
+    uint32_t    nEta = 0;
+    uint32_t    nPhi = 0;
+    std::string node = "";
+
+    ///! get no. of towers
+    std::size_t GetNTowers() const {return static_cast<std::size_t>(nEta) * nPhi;}
+  };
+
+  // ==========================================================================
+  //! Where to find an event in a record
+  // ==========================================================================
+  struct IndexEntry
+  {
+    uint64_t offset;
+    uint64_t event;
+    uint32_t run;
+    uint32_t size;
+  };
+
+  // ==========================================================================
+  //! Towers of one calorimeter in one event, flattened
+  // ==========================================================================
+  /*! Indexed by (iEta * nPhi) + iPhi.
+   */
+  struct Channels
+  {
+    std::vector<uint8_t> status;
+    std::vector<float>   energy;
+    std::vector<float>   time;
+
+    ///! size (and reset) for some no. of towers
+    void Reset(const std::size_t nTowers)
+    {
+      status.assign(nTowers, 0);
+      energy.assign(nTowers, -1.);
+      time.assign(nTowers, 0.);
+    }
+  };
+
+  // ==========================================================================
+  //! One event read back from a record
+  // ==========================================================================
+  /*! The snapshot points into the towers, so it's valid until the next
+   *  event is read into this one. Buffers are reused from event to event.
+   */
+  struct Event
+  {
+    uint32_t run   = 0;
+    uint64_t event = 0;
+    std::array<std::vector<BeamBackgroundFilterAndQADefs::Tower>, NCalos> towers;
+    std::array<std::vector<float>, NCalos>                                times;
+    BeamBackgroundFilterAndQADefs::TowerSnapshot                          snapshot;
+  };
+
+  // ==========================================================================
+  //! Writes a record event by event
+  // ==========================================================================
+  /*! For each event, fill the channels of each calorimeter (see
+   *  GetChannels) and then call Write.
+   */
+  class Writer
+  {
+
+    public:
+
+      // ctor/dtor
+      Writer() = default;
+      ~Writer();
+
+      // no copying: this owns an open file
+      Writer(const Writer&) = delete;
+      Writer& operator=(const Writer&) = delete;
+
+      // methods
+      bool Open(const std::string& path, const std::vector<Detector>& detectors, const int level = 1);
+      bool Write(const uint32_t run, const uint64_t event);
+      bool Close();
+
+      ///! get channels to fill for a calorimeter (in order of detectors)
+      Channels& GetChannels(const std::size_t iDetector) {return m_channels[iDetector];}
+
+      ///! get no. of events and bytes written so far
+      uint64_t GetNEvents() const {return m_index.size();}
+      uint64_t GetNBytes() const {return m_offset;}
+
+      ///! check if a file is open
+      bool IsOpen() const {return m_file.is_open();}
+
+    private:
+
+      ///! output file and current offset into it
+      std::ofstream m_file;
+      uint64_t      m_offset = 0;
+
+      ///! compression level (0 = none)
+      int m_level = 1;
+
+      ///! recorded calorimeters and their channels for current event
+      std::vector<Detector> m_detectors;
+      std::vector<Channels> m_channels;
+
+      ///! buffers for payload before and after deflating
+      std::vector<uint8_t> m_payload;
+      std::vector<uint8_t> m_compressed;
+
+      ///! index of all events written
+      std::vector<IndexEntry> m_index;
+
+  };  // end Writer
+
+  // ==========================================================================
+  //! Reads events from a (memory-mapped) record
+  // ==========================================================================
+  /*! n.b. Read reuses an internal buffer, so a reader shouldn't be shared
+   *  between threads; open one reader per thread instead.
+   */
+  class Reader
+  {
+
+    public:
+
+      // ctor/dtor
+      Reader() = default;
+      ~Reader();
+
+      // no copying: this owns a mapping
+      Reader(const Reader&) = delete;
+      Reader& operator=(const Reader&) = delete;
+
+      // methods
+      bool Open(const std::string& path);
+      bool Read(const uint64_t iEvent, Event& event);
+      void Close();
+
+      ///! get recorded calorimeters
+      const std::vector<Detector>& GetDetectors() const {return m_detectors;}
+
+      ///! get no. of events
+      uint64_t GetNEvents() const {return m_nEvents;}
+
+      ///! get compression level
+      int GetLevel() const {return m_level;}
+
+    private:
+
+      ///! mapped file
+      const char* m_data = nullptr;
+      std::size_t m_size = 0;
+
+      ///! file info
+      int                   m_level   = 0;
+      uint64_t              m_nEvents = 0;
+      uint64_t              m_index   = 0;
+      std::vector<Detector> m_detectors;
+
+      ///! buffer for inflated payload
+      std::vector<uint8_t> m_payload;
+
+  };  // end Reader
+
+}  // end TowerRecord namespace
+
+#endif
+
+// end ========================================================================
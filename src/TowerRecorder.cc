@@ -0,0 +1,247 @@
+/// ===========================================================================
+/*! \file    TowerRecorder.cc
+ *  \authors Derek Anderson
+ *  \date    10.16.2026
+ *
+ *  A F4A module to record the calorimeter towers the
+ *  beam background filters consume into a compact
+ *  binary tower record (see TowerRecord.h).
+ */
+/// ===========================================================================
+
+#define TOWERRECORDER_CC
+
+// c++ utiilites
+#include <algorithm>
+#include <cassert>
+#include <iostream>
+
+// calo base
+#include <calobase/TowerInfo.h>
+#include <calobase/TowerInfoContainer.h>
+
+// f4a libraries
+#include <fun4all/Fun4AllReturnCodes.h>
+#include <ffaobjects/EventHeader.h>
+
+// phool libraries
+#include <phool/getClass.h>
+#include <phool/phool.h>
+#include <phool/PHCompositeNode.h>
+
+// module components
+#include "BeamBackgroundFilterAndQADefs.h"
+#include "TowerRecorder.h"
+
+// alias for convenience
+namespace bbfqd = BeamBackgroundFilterAndQADefs;
+
+
+
+// ctor/dtor ==================================================================
+
+// ----------------------------------------------------------------------------
+//! Default module constructor
+// ----------------------------------------------------------------------------
+TowerRecorder::TowerRecorder(const std::string& name, const bool debug)
+  : SubsysReco(name)
+  , m_nEvtsSeen(0)
+{
+
+  m_config.moduleName = name;
+  m_config.debug      = debug;
+
+  // print debug message
+  if (debug && (Verbosity() > 0))
+  {
+    std::cout << "TowerRecorder::TowerRecorder(const std::string &name) Calling ctor" << std::endl;
+  }
+
+}  // end ctor(std::string&, bool)'
+
+
+
+// ----------------------------------------------------------------------------
+//! Module constructor accepting a configuration
+// ----------------------------------------------------------------------------
+TowerRecorder::TowerRecorder(const Config& config)
+  : SubsysReco(config.moduleName)
+  , m_config(config)
+  , m_nEvtsSeen(0)
+{
+
+  // print debug message
+  if (m_config.debug && (Verbosity() > 0))
+  {
+    std::cout << "TowerRecorder::TowerRecorder(Config&) Calling ctor" << std::endl;
+  }
+
+}  // end ctor(Config&)'
+
+
+
+// ----------------------------------------------------------------------------
+//! Module destructor
+// ----------------------------------------------------------------------------
+TowerRecorder::~TowerRecorder()
+{
+
+  // print debug message
+  if (m_config.debug && (Verbosity() > 0))
+  {
+    std::cout << "TowerRecorder::~TowerRecorder() Calling dtor" << std::endl;
+  }
+
+  /* nothing to do */
+
+}  // end dtor()
+
+
+
+// fun4all methods ============================================================
+
+// ----------------------------------------------------------------------------
+//! Initialize module
+// ----------------------------------------------------------------------------
+int TowerRecorder::Init(PHCompositeNode* /*topNode*/)
+{
+
+  if (m_config.debug)
+  {
+    std::cout << "TowerRecorder::Init(PHCompositeNode *topNode) Initializing" << std::endl;
+  }
+
+  // collect calorimeters to record
+  const std::vector<TowerRecord::Detector> candidates = {
+    {TowerRecord::EMCal, bbfqd::EMCalMap::nEta, bbfqd::EMCalMap::nPhi, m_config.emcalNode},
+    {TowerRecord::IHCal, bbfqd::IHCalMap::nEta, bbfqd::IHCalMap::nPhi, m_config.ihcalNode},
+    {TowerRecord::OHCal, bbfqd::OHCalMap::nEta, bbfqd::OHCalMap::nPhi, m_config.ohcalNode}
+  };
+  for (const auto& candidate : candidates)
+  {
+    if (!candidate.node.empty())
+    {
+      m_detectors.push_back(candidate);
+    }
+  }
+  m_warnedMissing.assign(m_detectors.size(), false);
+
+  // and open record
+  if (!m_writer.Open(m_config.outFile, m_detectors, m_config.compression))
+  {
+    std::cerr << PHWHERE << ": PANIC! Couldn't open tower record '" << m_config.outFile << "'!" << std::endl;
+    assert(m_writer.IsOpen());
+    return Fun4AllReturnCodes::ABORTRUN;
+  }
+  return Fun4AllReturnCodes::EVENT_OK;
+
+}  // end 'Init(PHCompositeNode*)'
+
+
+
+// ----------------------------------------------------------------------------
+//! Grab towers and record them
+// ----------------------------------------------------------------------------
+int TowerRecorder::process_event(PHCompositeNode* topNode)
+{
+
+  if (m_config.debug && (Verbosity() > 1))
+  {
+    std::cout << "TowerRecorder::process_event(PHCompositeNode *topNode) Recording event" << std::endl;
+  }
+
+  // grab run and event no.
+  uint32_t run   = 0;
+  uint64_t event = m_nEvtsSeen++;
+
+  EventHeader* header = findNode::getClass<EventHeader>(topNode, "EventHeader");
+  if (header)
+  {
+    run   = header->get_RunNumber();
+    event = header->get_EvtSequence();
+  }
+
+  // fill channels of each calorimeter
+  for (std::size_t iDetector = 0; iDetector < m_detectors.size(); ++iDetector)
+  {
+    TowerInfoContainer* container = findNode::getClass<TowerInfoContainer>(topNode, m_detectors[iDetector].node);
+    if (!container && !m_warnedMissing[iDetector])
+    {
+      std::cerr << PHWHERE << ": WARNING: no node '" << m_detectors[iDetector].node << "', recording its towers as empty" << std::endl;
+      m_warnedMissing[iDetector] = true;
+    }
+    FillChannels(container, m_detectors[iDetector], m_writer.GetChannels(iDetector));
+  }
+
+  // and write event
+  if (!m_writer.Write(run, event))
+  {
+    std::cerr << PHWHERE << ": PANIC! Couldn't write event " << event << " to tower record!" << std::endl;
+    return Fun4AllReturnCodes::ABORTRUN;
+  }
+  return Fun4AllReturnCodes::EVENT_OK;
+
+}  // end 'process_event(PHCompositeNode*)'
+
+
+
+// ----------------------------------------------------------------------------
+//! Close record
+// ----------------------------------------------------------------------------
+int TowerRecorder::End(PHCompositeNode* /*topNode*/)
+{
+
+  if (m_config.debug)
+  {
+    std::cout << "TowerRecorder::End(PHCompositeNode *topNode) This is the end..." << std::endl;
+  }
+
+  const uint64_t nEvents = m_writer.GetNEvents();
+  const uint64_t nBytes  = m_writer.GetNBytes();
+  if (!m_writer.Close())
+  {
+    std::cerr << PHWHERE << ": WARNING: couldn't finish tower record '" << m_config.outFile << "'" << std::endl;
+  }
+  std::cout << "TowerRecorder::End(PHCompositeNode *topNode) Recorded " << nEvents << " events ("
+            << nBytes / std::max<uint64_t>(nEvents, 1) << " bytes/event) to " << m_config.outFile << std::endl;
+  return Fun4AllReturnCodes::EVENT_OK;
+
+}  // end 'End(PHCompositeNode*)'
+
+
+
+// private methods ============================================================
+
+// ----------------------------------------------------------------------------
+//! Copy towers of a container into flat channels
+// ----------------------------------------------------------------------------
+/*! Towers which aren't in the container (or all of them, if there's no
+ *  container) are left reset, like in a TowerMap.
+ */
+void TowerRecorder::FillChannels(
+  TowerInfoContainer* container,
+  const TowerRecord::Detector& detector,
+  TowerRecord::Channels& channels
+) {
+
+  channels.Reset(detector.GetNTowers());
+  if (!container) return;
+
+  for (std::size_t iTwr = 0; iTwr < container->size(); ++iTwr)
+  {
+    const uint32_t key  = container->encode_key(iTwr);
+    const uint32_t iEta = container->getTowerEtaBin(key);
+    const uint32_t iPhi = container->getTowerPhiBin(key);
+    if ((iEta >= detector.nEta) || (iPhi >= detector.nPhi)) continue;
+
+    TowerInfo*        tower = container->get_tower_at_channel(iTwr);
+    const std::size_t index = (iEta * detector.nPhi) + iPhi;
+    channels.status[index]  = tower->get_status();
+    channels.energy[index]  = tower->get_energy();
+    channels.time[index]    = tower->get_time_float();
+  }
+  return;
+
+}  // end 'FillChannels(TowerInfoContainer*, TowerRecord::Detector&, TowerRecord::Channels&)'
+
+// end ========================================================================
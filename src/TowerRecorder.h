@@ -0,0 +1,104 @@
+/// ===========================================================================
+/*! \file    TowerRecorder.h
+ *  \authors Derek Anderson
+ *  \date    10.16.2026
+ *
+ *  A F4A module to record the calorimeter towers the
+ *  beam background filters consume into a compact
+ *  binary tower record (see TowerRecord.h).
+ */
+/// ===========================================================================
+
+#ifndef TOWERRECORDER_H
+#define TOWERRECORDER_H
+
+// c++ utilities
+#include <string>
+#include <vector>
+
+// f4a libraries
+#include <fun4all/SubsysReco.h>
+
+// module components
+#include "TowerRecord.h"
+
+// forward declarations
+class PHCompositeNode;
+class TowerInfoContainer;
+
+
+
+// ============================================================================
+//! Record calorimeter towers for replay
+// ============================================================================
+/*! A F4A module which writes the energy, status, and time of every tower
+ *  of the requested calorimeters to a tower record each event. Records
+ *  can then be replayed through any filter (see ReplayTowerRecord.cc)
+ *  without DSTs, ROOT I/O, or a node tree.
+ */
+class TowerRecorder : public SubsysReco {
+
+  public:
+
+    // ========================================================================
+    //! User options for module
+    // ========================================================================
+    struct Config
+    {
+      // turn modes on/off
+      bool debug = false;
+
+      ///! module name
+      std::string moduleName = "TowerRecorder";
+
+      ///! output record
+      std::string outFile = "towers.bbfr";
+
+      ///! nodes to record for each calorimeter (empty = don't record)
+      std::string emcalNode = "TOWERINFO_CALIB_CEMC";
+      std::string ihcalNode = "TOWERINFO_CALIB_HCALIN";
+      std::string ohcalNode = "TOWERINFO_CALIB_HCALOUT";
+
+      ///! compression level (0 = none, 1 = fastest, 9 = smallest)
+      int compression = 1;
+    };
+
+    // ctor/dtor
+    TowerRecorder(const std::string& name = "TowerRecorder", const bool debug = false);
+    TowerRecorder(const Config& config);
+    ~TowerRecorder() override;
+
+    // setters
+    void SetConfig(const Config& config) {m_config = config;}
+
+    // getters
+    Config GetConfig() const {return m_config;}
+
+    // f4a methods
+    int Init(PHCompositeNode* /*topNode*/) override;
+    int process_event(PHCompositeNode* topNode) override;
+    int End(PHCompositeNode* /*topNode*/) override;
+
+  private:
+
+    // private methods
+    void FillChannels(TowerInfoContainer* container, const TowerRecord::Detector& detector, TowerRecord::Channels& channels);
+
+    ///! module configuration
+    Config m_config;
+
+    ///! record being written and calorimeters in it
+    TowerRecord::Writer                m_writer;
+    std::vector<TowerRecord::Detector> m_detectors;
+
+    ///! whether a missing node has been warned about yet
+    std::vector<bool> m_warnedMissing;
+
+    ///! no. of events seen so far
+    uint64_t m_nEvtsSeen;
+
+};  // end TowerRecorder
+
+#endif
+
+// end ========================================================================
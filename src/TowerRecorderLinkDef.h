@@ -0,0 +1,20 @@
+/// ===========================================================================
+/*! \file    TowerRecorderLinkDef.h
+ *  \authors Derek Anderson
+ *  \date    10.16.2026
+ *
+ *  A F4A module to record the calorimeter towers the
+ *  beam background filters consume into a compact
+ *  binary tower record (see TowerRecord.h).
+ */
+/// ===========================================================================
+
+#pragma once
+
+#ifdef __CINT__
+
+#pragma link C++ class TowerRecorder
+
+#endif  // end if __CINT__
+
+// end ========================================================================